@@ -0,0 +1,332 @@
+#include "head.hpp"
+#include "limbs.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <stdexcept>
+
+// Замеры операций LongNumber по размерам операндов и таблица алгоритмов умножения.
+//
+//   bench [--ops add,sub,mul,div,shr,cmp,eq,from_string,to_string]
+//         [--min-bits B] [--max-bits B] [--warmup N] [--reps N] [--time-limit S]
+//         [--format table|csv|json]
+//   bench --mul-algorithms [max_limbs]    (или bench max_limbs)
+
+namespace {
+
+    using bench_clock = std::chrono::steady_clock;
+
+    // Не даёт компилятору выбросить результат замеряемой операции
+    volatile std::size_t sink = 0;
+
+    struct options {
+        std::vector<std::string> ops = {"add", "sub", "mul", "div", "shr", "cmp", "eq", "from_string", "to_string"};
+        std::size_t min_bits = 64;
+        std::size_t max_bits = 10000000;
+        int warmup = 2;
+        int reps = 21;
+        double time_limit = 2.0;
+        std::string format = "table";
+    };
+
+    struct result {
+        std::string op;
+        std::size_t bits;
+        std::size_t samples;
+        std::size_t batch;
+        double min_ns;
+        double median_ns;
+        double p99_ns;
+        double mean_ns;
+    };
+
+    // Операнды одного размера: bits бит всего, половина из них — дробная часть
+    struct operands {
+        int precision;
+        std::string text;
+        LongNumber a;
+        LongNumber b;
+        LongNumber a_copy;
+    };
+
+    std::string random_digits(std::mt19937_64 &gen, std::size_t count)
+    {
+        std::string s(count, '0');
+        for (auto &c : s)
+            c = static_cast<char>('0' + gen() % 10);
+        s[0] = static_cast<char>('1' + gen() % 9);
+        return s;
+    }
+
+    operands make_operands(std::mt19937_64 &gen, std::size_t bits)
+    {
+        int precision = static_cast<int>(bits / 2);
+        // Десятичных цифр в целой части: (bits - precision) * log10(2)
+        std::size_t digits = std::max<std::size_t>(1, (bits - precision) * 30103 / 100000);
+        std::string text_a = random_digits(gen, digits) + "." + random_digits(gen, digits);
+        std::string text_b = random_digits(gen, digits) + "." + random_digits(gen, digits);
+        LongNumber a(text_a, precision);
+        LongNumber b(text_b, precision);
+        LongNumber a_copy(a);
+        return {precision, text_a, std::move(a), std::move(b), std::move(a_copy)};
+    }
+
+    std::function<void()> make_op(const std::string &op, const operands &x)
+    {
+        if (op == "add")
+            return [&x] { sink = sink + (x.a + x.b).get_limbs().size(); };
+        if (op == "sub")
+            return [&x] { sink = sink + (x.a - x.b).get_limbs().size(); };
+        if (op == "mul")
+            return [&x] { sink = sink + (x.a * x.b).get_limbs().size(); };
+        if (op == "div")
+            return [&x] { sink = sink + (x.a / x.b).get_limbs().size(); };
+        if (op == "shr")
+            return [&x] { sink = sink + (x.a >> (x.precision / 3 + 1)).get_limbs().size(); };
+        // Сравнение равных по модулю чисел — худший случай, просмотр всех слов
+        if (op == "cmp")
+            return [&x] { sink = sink + (x.a < x.a_copy); };
+        if (op == "eq")
+            return [&x] { sink = sink + (x.a == x.a_copy); };
+        if (op == "from_string")
+            return [&x] { sink = sink + LongNumber(x.text, x.precision).get_limbs().size(); };
+        if (op == "to_string")
+            return [&x] { sink = sink + x.a.to_string().size(); };
+        throw std::invalid_argument("unknown operation: " + op);
+    }
+
+    double elapsed_ns(bench_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    }
+
+    // Выборка времён одного вызова. Быстрые операции гоняются пачками не короче 20 мкс
+    // (время делится на размер пачки); первые warmup выборок отбрасываются
+    result measure(const std::string &op, std::size_t bits, const std::function<void()> &f, const options &opt)
+    {
+        auto start = bench_clock::now();
+        f();
+        double once = elapsed_ns(start);
+        std::size_t batch = once >= 20000.0 ? 1 : static_cast<std::size_t>(20000.0 / std::max(once, 1.0)) + 1;
+
+        std::vector<double> samples;
+        auto total_start = bench_clock::now();
+        for (int i = 0; i < opt.warmup + opt.reps; ++i)
+        {
+            auto t0 = bench_clock::now();
+            for (std::size_t j = 0; j < batch; ++j)
+                f();
+            double t = elapsed_ns(t0) / batch;
+            if (i >= opt.warmup)
+                samples.push_back(t);
+            // Долгие операции ограничены по времени, но не меньше трёх выборок
+            if (samples.size() >= 3 && elapsed_ns(total_start) > opt.time_limit * 1e9)
+                break;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        std::size_t n = samples.size();
+        double sum = 0;
+        for (double t : samples)
+            sum += t;
+        // p99 — ближайший ранг: наименьшее значение, не меньше которого 99% выборок
+        std::size_t p99 = (99 * n + 99) / 100 - 1;
+        double median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        return {op, bits, n, batch, samples.front(), median, samples[std::min(p99, n - 1)], sum / n};
+    }
+
+    std::vector<std::size_t> sizes(const options &opt)
+    {
+        std::vector<std::size_t> result;
+        for (std::size_t bits = opt.min_bits; bits <= opt.max_bits; bits *= 4)
+            result.push_back(bits);
+        if (result.empty() || result.back() != opt.max_bits)
+            result.push_back(opt.max_bits);
+        return result;
+    }
+
+    void print_header(const options &opt)
+    {
+        if (opt.format == "csv")
+        {
+            std::cout << "op,bits,samples,batch,min_ns,median_ns,p99_ns,mean_ns\n";
+        }
+        else if (opt.format == "json")
+        {
+            std::cout << "{\n  \"simd\": \"" << limbs::simd_name() << "\",\n  \"mul_basecase\": \""
+                      << limbs::mul_basecase_name() << "\",\n  \"results\": [";
+        }
+        else
+        {
+            std::cout << "simd: " << limbs::simd_name() << ", mul_basecase: " << limbs::mul_basecase_name() << "\n"
+                      << std::setw(12) << "op" << std::setw(10) << "bits" << std::setw(9) << "samples"
+                      << std::setw(16) << "median (ns)" << std::setw(16) << "p99 (ns)" << std::setw(16) << "min (ns)" << "\n";
+        }
+    }
+
+    void print_result(const result &r, const options &opt, bool first)
+    {
+        if (opt.format == "csv")
+        {
+            std::cout << r.op << ',' << r.bits << ',' << r.samples << ',' << r.batch << ',' << r.min_ns << ','
+                      << r.median_ns << ',' << r.p99_ns << ',' << r.mean_ns << std::endl;
+        }
+        else if (opt.format == "json")
+        {
+            std::cout << (first ? "\n" : ",\n") << "    {\"op\": \"" << r.op << "\", \"bits\": " << r.bits
+                      << ", \"samples\": " << r.samples << ", \"batch\": " << r.batch << ", \"min_ns\": " << r.min_ns
+                      << ", \"median_ns\": " << r.median_ns << ", \"p99_ns\": " << r.p99_ns << ", \"mean_ns\": " << r.mean_ns
+                      << "}" << std::flush;
+        }
+        else
+        {
+            std::cout << std::setw(12) << r.op << std::setw(10) << r.bits << std::setw(9) << r.samples
+                      << std::setw(16) << r.median_ns << std::setw(16) << r.p99_ns << std::setw(16) << r.min_ns << std::endl;
+        }
+    }
+
+    void run_operations(const options &opt)
+    {
+        std::mt19937_64 gen(1);
+        std::cout << std::fixed << std::setprecision(1);
+        print_header(opt);
+        bool first = true;
+        for (std::size_t bits : sizes(opt))
+        {
+            operands x = make_operands(gen, bits);
+            for (const std::string &op : opt.ops)
+            {
+                print_result(measure(op, bits, make_op(op, x), opt), opt, first);
+                first = false;
+            }
+        }
+        if (opt.format == "json")
+            std::cout << "\n  ]\n}\n";
+    }
+
+    // Время одного умножения n x n слов заданным алгоритмом, в микросекундах
+    double time_mul(limbs::mul_algorithm algorithm, const limbs::limb_vector &a, const limbs::limb_vector &b)
+    {
+        size_t n = a.size();
+        limbs::limb_vector r(2 * n);
+        int reps = 0;
+        auto start_time = bench_clock::now();
+        std::chrono::duration<double, std::micro> elapsed(0);
+        do
+        {
+            limbs::mul_with(algorithm, r.data(), a.data(), n, b.data(), n);
+            reps++;
+            elapsed = bench_clock::now() - start_time;
+        } while (elapsed.count() < 200000 && reps < 1000);
+        return elapsed.count() / reps;
+    }
+
+    void run_mul_algorithms(size_t max_limbs)
+    {
+        std::mt19937_64 gen(1);
+
+        std::cout << std::setw(10) << "limbs" << std::setw(14) << "basecase" << std::setw(14) << "karatsuba"
+                  << std::setw(14) << "toom3" << std::setw(14) << "ntt" << "   (us)\n";
+        for (size_t n = 8; n <= max_limbs; n *= 2)
+        {
+            limbs::limb_vector a(n), b(n);
+            for (auto &x : a)
+                x = gen();
+            for (auto &x : b)
+                x = gen();
+
+            std::cout << std::setw(10) << n;
+            for (auto algorithm : {limbs::mul_algorithm::basecase, limbs::mul_algorithm::karatsuba,
+                                   limbs::mul_algorithm::toom3, limbs::mul_algorithm::ntt})
+            {
+                // Квадратичный алгоритм на больших размерах не замеряем
+                if (algorithm == limbs::mul_algorithm::basecase && n > 8192)
+                {
+                    std::cout << std::setw(14) << "-";
+                    continue;
+                }
+                std::cout << std::setw(14) << std::fixed << std::setprecision(1) << time_mul(algorithm, a, b);
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    std::vector<std::string> split(const std::string &list)
+    {
+        std::vector<std::string> result;
+        std::size_t start = 0;
+        while (start <= list.size())
+        {
+            std::size_t end = list.find(',', start);
+            if (end == std::string::npos)
+                end = list.size();
+            if (end > start)
+                result.push_back(list.substr(start, end - start));
+            start = end + 1;
+        }
+        return result;
+    }
+
+} // end anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    std::string first = argc > 1 ? argv[1] : "";
+    if (first == "--mul-algorithms" || (!first.empty() && std::isdigit(static_cast<unsigned char>(first[0]))))
+    {
+        std::size_t arg = first == "--mul-algorithms" ? 2 : 1;
+        run_mul_algorithms(argc > static_cast<int>(arg) ? std::stoul(argv[arg]) : 65536);
+        return 0;
+    }
+
+    options opt;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--ops")
+                opt.ops = split(value);
+            else if (arg == "--min-bits")
+                opt.min_bits = std::max<std::size_t>(64, std::stoull(value));
+            else if (arg == "--max-bits")
+                opt.max_bits = std::stoull(value);
+            else if (arg == "--warmup")
+                opt.warmup = std::max(0, std::stoi(value));
+            else if (arg == "--reps")
+                opt.reps = std::max(1, std::stoi(value));
+            else if (arg == "--time-limit")
+                opt.time_limit = std::stod(value);
+            else if (arg == "--format" && (value == "table" || value == "csv" || value == "json"))
+                opt.format = value;
+            else
+                throw std::invalid_argument("unknown option: " + arg + " " + value);
+        }
+        // Неизвестная операция обнаруживается до начала замеров
+        std::mt19937_64 gen(1);
+        operands probe = make_operands(gen, 64);
+        for (const std::string &op : opt.ops)
+            make_op(op, probe);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n"
+                  << "usage: bench [--ops add,sub,mul,div,shr,cmp,eq,from_string,to_string] [--min-bits B]\n"
+                  << "             [--max-bits B] [--warmup N] [--reps N] [--time-limit S] [--format table|csv|json]\n"
+                  << "       bench --mul-algorithms [max_limbs]\n";
+        return 1;
+    }
+
+    run_operations(opt);
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include "limbs.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define LONGNUM_MULX 1
+#include <cpuid.h>
+#endif
+
+namespace limbs {
+
+    namespace {
+
+        // Переносимые ядра на unsigned __int128
+        limb_t mul_1_generic(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            limb_t carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                dlimb_t p = static_cast<dlimb_t>(a[i]) * b + carry;
+                r[i] = static_cast<limb_t>(p);
+                carry = static_cast<limb_t>(p >> LIMB_BITS);
+            }
+            return carry;
+        }
+
+        limb_t addmul_1_generic(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            limb_t carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                dlimb_t p = static_cast<dlimb_t>(a[i]) * b + r[i] + carry;
+                r[i] = static_cast<limb_t>(p);
+                carry = static_cast<limb_t>(p >> LIMB_BITS);
+            }
+            return carry;
+        }
+
+        void mul_basecase_generic(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+        {
+            r[an] = mul_1_generic(r, a, an, b[0]);
+            for (size_t j = 1; j < bn; ++j)
+            {
+                r[an + j] = addmul_1_generic(r + j, a, an, b[j]);
+            }
+        }
+
+        // Квадрат: произведения a[i] * a[j] при i < j считаются по одному разу строками
+        // addmul_1, затем сумма удваивается и к ней прибавляются квадраты a[i]^2
+        template <limb_t (*Mul1)(limb_t *, const limb_t *, size_t, limb_t),
+                  limb_t (*AddMul1)(limb_t *, const limb_t *, size_t, limb_t)>
+        void sqr_rows(limb_t *r, const limb_t *a, size_t n)
+        {
+            if (n == 1)
+            {
+                dlimb_t p = static_cast<dlimb_t>(a[0]) * a[0];
+                r[0] = static_cast<limb_t>(p);
+                r[1] = static_cast<limb_t>(p >> LIMB_BITS);
+                return;
+            }
+            r[0] = 0;
+            r[n] = Mul1(r + 1, a + 1, n - 1, a[0]);
+            for (size_t i = 1; i + 1 < n; ++i)
+                r[n + i] = AddMul1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+            r[2 * n - 1] = 0;
+
+            // Удвоение (сдвиг на 1 бит на лету) и диагональ за один проход
+            limb_t carry = 0, top = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                limb_t lo = r[2 * i], hi = r[2 * i + 1];
+                limb_t dlo = (lo << 1) | top;
+                limb_t dhi = (hi << 1) | (lo >> (LIMB_BITS - 1));
+                top = hi >> (LIMB_BITS - 1);
+                dlimb_t p = static_cast<dlimb_t>(a[i]) * a[i];
+                dlimb_t t = static_cast<dlimb_t>(dlo) + static_cast<limb_t>(p) + carry;
+                r[2 * i] = static_cast<limb_t>(t);
+                t = static_cast<dlimb_t>(dhi) + static_cast<limb_t>(p >> LIMB_BITS) + static_cast<limb_t>(t >> LIMB_BITS);
+                r[2 * i + 1] = static_cast<limb_t>(t);
+                carry = static_cast<limb_t>(t >> LIMB_BITS);
+            }
+        }
+
+        void sqr_basecase_generic(limb_t *r, const limb_t *a, size_t n)
+        {
+            sqr_rows<mul_1_generic, addmul_1_generic>(r, a, n);
+        }
+
+        // Короткое произведение: строки addmul_1, начинающиеся со столбца c0
+        template <limb_t (*AddMul1)(limb_t *, const limb_t *, size_t, limb_t)>
+        void mulhigh_rows(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0)
+        {
+            std::fill(r, r + an + bn - c0, 0);
+            for (size_t j = 0; j < bn; ++j)
+            {
+                size_t i0 = c0 > j ? c0 - j : 0;
+                if (i0 >= an)
+                    continue;
+                r[an + j - c0] = AddMul1(r + i0 + j - c0, a + i0, an - i0, b[j]);
+            }
+        }
+
+        void mulhigh_basecase_generic(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0)
+        {
+            mulhigh_rows<addmul_1_generic>(r, a, an, b, bn, c0);
+        }
+
+#ifdef LONGNUM_MULX
+
+        // BMI2 + ADX: mulx не трогает флаги, поэтому в addmul_1 идут две независимые
+        // цепочки переносов — adox (старшее слово предыдущего произведения + младшее
+        // текущего) и adcx (прибавление к r[i]). Цикл развёрнут на 4 слова; счётчик
+        // меняется через lea и проверяется jrcxz, которые флаги не портят.
+        // Остаток n mod 4 младших слов считается переносимым кодом
+        limb_t mul_1_mulx(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            size_t head = n % 4;
+            limb_t carry = mul_1_generic(r, a, head, b);
+            if (n == head)
+                return carry;
+            long i = -static_cast<long>(n - head);
+            limb_t lo, hi;
+            __asm__("xor %k[lo], %k[lo]\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+                    "adcx %[c], %[lo]\n\t"
+                    "mov %[lo], (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %[lo], %[c]\n\t"
+                    "adcx %[hi], %[lo]\n\t"
+                    "mov %[lo], 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %[lo], %[hi]\n\t"
+                    "adcx %[c], %[lo]\n\t"
+                    "mov %[lo], 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %[lo], %[c]\n\t"
+                    "adcx %[hi], %[lo]\n\t"
+                    "mov %[lo], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "mov $0, %k[lo]\n\t"
+                    "adcx %[lo], %[c]\n\t"
+                    : [c] "+&r"(carry), [i] "+&c"(i), [lo] "=&r"(lo), [hi] "=&r"(hi)
+                    : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        limb_t addmul_1_mulx(limb_t *r, const limb_t *a, size_t n, limb_t b)
+        {
+            size_t head = n % 4;
+            limb_t carry = addmul_1_generic(r, a, head, b);
+            if (n == head)
+                return carry;
+            long i = -static_cast<long>(n - head);
+            limb_t lo, hi;
+            __asm__("xor %k[lo], %k[lo]\n\t"
+                    "1:\n\t"
+                    "mulx (%[a],%[i],8), %[lo], %[hi]\n\t"
+                    "adox %[c], %[lo]\n\t"
+                    "adcx (%[r],%[i],8), %[lo]\n\t"
+                    "mov %[lo], (%[r],%[i],8)\n\t"
+                    "mulx 8(%[a],%[i],8), %[lo], %[c]\n\t"
+                    "adox %[hi], %[lo]\n\t"
+                    "adcx 8(%[r],%[i],8), %[lo]\n\t"
+                    "mov %[lo], 8(%[r],%[i],8)\n\t"
+                    "mulx 16(%[a],%[i],8), %[lo], %[hi]\n\t"
+                    "adox %[c], %[lo]\n\t"
+                    "adcx 16(%[r],%[i],8), %[lo]\n\t"
+                    "mov %[lo], 16(%[r],%[i],8)\n\t"
+                    "mulx 24(%[a],%[i],8), %[lo], %[c]\n\t"
+                    "adox %[hi], %[lo]\n\t"
+                    "adcx 24(%[r],%[i],8), %[lo]\n\t"
+                    "mov %[lo], 24(%[r],%[i],8)\n\t"
+                    "lea 4(%[i]), %[i]\n\t"
+                    "jrcxz 2f\n\t"
+                    "jmp 1b\n\t"
+                    "2:\n\t"
+                    "mov $0, %k[lo]\n\t"
+                    "adox %[lo], %[c]\n\t"
+                    "adcx %[lo], %[c]\n\t"
+                    : [c] "+&r"(carry), [i] "+&c"(i), [lo] "=&r"(lo), [hi] "=&r"(hi)
+                    : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+                    : "cc", "memory");
+            return carry;
+        }
+
+        void mul_basecase_mulx(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+        {
+            r[an] = mul_1_mulx(r, a, an, b[0]);
+            for (size_t j = 1; j < bn; ++j)
+            {
+                r[an + j] = addmul_1_mulx(r + j, a, an, b[j]);
+            }
+        }
+
+        void sqr_basecase_mulx(limb_t *r, const limb_t *a, size_t n)
+        {
+            sqr_rows<mul_1_mulx, addmul_1_mulx>(r, a, n);
+        }
+
+        void mulhigh_basecase_mulx(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0)
+        {
+            mulhigh_rows<addmul_1_mulx>(r, a, an, b, bn, c0);
+        }
+
+        bool has_mulx()
+        {
+            // CPUID, лист 7: EBX бит 8 — BMI2 (mulx), бит 19 — ADX (adcx/adox)
+            unsigned eax, ebx, ecx, edx;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return false;
+            return (ebx & (1u << 8)) && (ebx & (1u << 19));
+        }
+
+#endif
+
+        struct basecase_kernels {
+            const char *name;
+            limb_t (*mul_1)(limb_t *, const limb_t *, size_t, limb_t);
+            limb_t (*addmul_1)(limb_t *, const limb_t *, size_t, limb_t);
+            void (*mul_basecase)(limb_t *, const limb_t *, size_t, const limb_t *, size_t);
+            void (*sqr_basecase)(limb_t *, const limb_t *, size_t);
+            void (*mulhigh_basecase)(limb_t *, const limb_t *, size_t, const limb_t *, size_t, size_t);
+        };
+
+        // LONGNUM_MUL_BASECASE=generic отключает mulx/adx, чтобы переносимый вариант
+        // можно было проверить и на процессоре с BMI2 + ADX
+        basecase_kernels select_kernels()
+        {
+#ifdef LONGNUM_MULX
+            const char *want = std::getenv("LONGNUM_MUL_BASECASE");
+            if (has_mulx() && (want == nullptr || std::strcmp(want, "generic") != 0))
+                return {"mulx/adx", mul_1_mulx, addmul_1_mulx, mul_basecase_mulx, sqr_basecase_mulx, mulhigh_basecase_mulx};
+#endif
+            return {"generic", mul_1_generic, addmul_1_generic, mul_basecase_generic, sqr_basecase_generic, mulhigh_basecase_generic};
+        }
+
+        const basecase_kernels &kernels()
+        {
+            static const basecase_kernels k = select_kernels();
+            return k;
+        }
+
+    } // end anonymous namespace
+
+    limb_t mul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        return kernels().mul_1(r, a, n, b);
+    }
+
+    limb_t addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        return kernels().addmul_1(r, a, n, b);
+    }
+
+    void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        kernels().mul_basecase(r, a, an, b, bn);
+    }
+
+    void sqr_basecase(limb_t *r, const limb_t *a, size_t n)
+    {
+        kernels().sqr_basecase(r, a, n);
+    }
+
+    void mulhigh_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0)
+    {
+        kernels().mulhigh_basecase(r, a, an, b, bn, c0);
+    }
+
+    const char *mul_basecase_name()
+    {
+        return kernels().name;
+    }
+
+} // namespace limbs
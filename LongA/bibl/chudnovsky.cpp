@@ -0,0 +1,88 @@
+#include "head.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace {
+
+    // 640320^3 / 24
+    constexpr std::int64_t C3_OVER_24 = 10939058860032000LL;
+    constexpr std::int64_t A_CONST = 13591409;
+    constexpr std::int64_t B_CONST = 545140134;
+    // Количество верных битов на один член ряда: log2(640320^3 / 1728)
+    constexpr double BITS_PER_TERM = 47.11041313821584;
+    // Поддеревья меньше этого числа членов считаются в одном потоке
+    constexpr std::int64_t PARALLEL_MIN_TERMS = 64;
+
+    // Целые P(a, b), Q(a, b), T(a, b) двоичного разбиения (точность 0)
+    struct split_result {
+        LongNumber P;
+        LongNumber Q;
+        LongNumber T;
+    };
+
+    LongNumber integer(std::int64_t value)
+    {
+        LongNumber result(0.0, 0, false);
+        result += value;
+        return result;
+    }
+
+    split_result binary_split(std::int64_t a, std::int64_t b, ThreadPool *pool)
+    {
+        if (b - a == 1)
+        {
+            if (a == 0)
+            {
+                return {integer(1), integer(1), integer(A_CONST)};
+            }
+            LongNumber P = integer(6 * a - 5) * (2 * a - 1) * (6 * a - 1);
+            LongNumber Q = integer(a) * a * a * C3_OVER_24;
+            LongNumber T = P * (A_CONST + B_CONST * a);
+            if (a % 2 == 1)
+                T = -T;
+            return {P, Q, T};
+        }
+        std::int64_t m = (a + b) / 2;
+        if (pool != nullptr && b - a >= PARALLEL_MIN_TERMS)
+        {
+            // Левое поддерево и произведения P, Q отдаём пулу, остальное считаем сами
+            auto left_future = pool->submit([=] { return binary_split(a, m, pool); });
+            split_result right = binary_split(m, b, pool);
+            split_result left = pool->wait(left_future);
+            auto P = pool->submit([&] { return left.P * right.P; });
+            auto Q = pool->submit([&] { return left.Q * right.Q; });
+            LongNumber T = right.Q * left.T + left.P * right.T;
+            return {pool->wait(P), pool->wait(Q), T};
+        }
+        split_result left = binary_split(a, m, pool);
+        split_result right = binary_split(m, b, pool);
+        return {left.P * right.P, left.Q * right.Q, right.Q * left.T + left.P * right.T};
+    }
+
+} // end anonymous namespace
+
+LongNumber LongNumber::calculate_pi_chudnovsky(int precision_, unsigned threads)
+{
+    // Запас битов на погрешность усечений при финальных операциях
+    const int guard_bits = 64;
+    int work_precision = precision_ + guard_bits;
+    std::int64_t terms = static_cast<std::int64_t>(work_precision / BITS_PER_TERM) + 1;
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1)
+        pool = std::make_unique<ThreadPool>(threads);
+
+    // pi = 426880 * sqrt(10005) * Q / T, корень считается параллельно с рядом
+    LongNumber root(10005.0, work_precision, false);
+    std::future<LongNumber> root_future;
+    if (pool)
+        root_future = pool->submit([&] { return root.sqrt(); });
+    split_result s = binary_split(0, terms, pool.get());
+    root = pool ? pool->wait(root_future) : root.sqrt();
+    s.Q.new_precision(work_precision);
+    s.T.new_precision(work_precision);
+    LongNumber pi = (root * s.Q * 426880) / s.T;
+    pi.new_precision(precision_);
+    return pi;
+}
@@ -0,0 +1,163 @@
+#include "limbs.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace limbs {
+
+    namespace {
+
+        limb_vector power_of_two(size_t bits)
+        {
+            limb_vector v;
+            set_bit(v, bits);
+            return v;
+        }
+
+        const limb_vector &one()
+        {
+            static const limb_vector value{1};
+            return value;
+        }
+
+        void divrem_schoolbook(const limb_vector &a, const limb_vector &b, limb_vector &q, limb_vector &r)
+        {
+            q.assign(a.size() - b.size() + 1, 0);
+            r.assign(b.size(), 0);
+            divrem(q.data(), r.data(), a.data(), a.size(), b.data(), b.size());
+            normalize(q);
+            normalize(r);
+        }
+
+        // Приближение floor(2^(2k) / d) для d из [2^(k-1), 2^k) с ошибкой в несколько единиц,
+        // итерации Ньютона с удвоением точности
+        limb_vector reciprocal(const limb_vector &d, size_t k)
+        {
+            limb_vector two_k = power_of_two(2 * k);
+            if (k <= DIV_NEWTON_THRESHOLD * LIMB_BITS)
+            {
+                limb_vector q, r;
+                divrem_schoolbook(two_k, d, q, r);
+                return q;
+            }
+
+            // Приближение по старшим h битам делителя
+            size_t h = (k + 1) / 2 + 4;
+            limb_vector xh = reciprocal(shr(d, k - h), h);
+            limb_vector x = shl(xh, k - h);
+
+            // x' = x + x * (2^(2k) - d * x) / 2^(2k); поправка мала, поэтому
+            // её достаточно умножать на h-битное приближение xh
+            limb_vector p = shl(mul(d, xh), k - h);
+            if (cmp(p, two_k) <= 0)
+                x = add(x, shr(mul(xh, sub(two_k, p)), k + h));
+            else
+                x = sub(x, shr(mul(xh, sub(p, two_k)), k + h));
+            return x;
+        }
+
+        // Деление через обратную величину: несколько умножений вместо O(n^2)
+        void divrem_newton(const limb_vector &a, const limb_vector &b, limb_vector &q, limb_vector &r)
+        {
+            size_t abits = bit_length(a);
+            size_t bbits = bit_length(b);
+            size_t qbits = abits - bbits + 1;
+            size_t k = qbits + LIMB_BITS;
+
+            limb_vector d = bbits >= k ? shr(b, bbits - k) : shl(b, k - bbits);
+            limb_vector x = reciprocal(d, k);
+
+            size_t s = abits > qbits + k ? abits - qbits - k : 0;
+            q = shr(mul(shr(a, s), x), k + bbits - s);
+
+            limb_vector p = mul(q, b);
+            while (cmp(p, a) > 0)
+            {
+                q = sub(q, one());
+                p = sub(p, b);
+            }
+            r = sub(a, p);
+            while (cmp(r, b) >= 0)
+            {
+                q = add(q, one());
+                r = sub(r, b);
+            }
+        }
+
+    } // end anonymous namespace
+
+    void divrem(const limb_vector &a, const limb_vector &b, limb_vector &q, limb_vector &r)
+    {
+        if (cmp(a, b) < 0)
+        {
+            q.clear();
+            r = a;
+            return;
+        }
+
+        // Младшие нулевые слова делителя сокращаем сразу
+        size_t tz = 0;
+        while (b[tz] == 0)
+            ++tz;
+        if (tz > 0)
+        {
+            limb_vector a_high(a.begin() + tz, a.end());
+            limb_vector b_high(b.begin() + tz, b.end());
+            divrem(a_high, b_high, q, r);
+            r.insert(r.begin(), a.begin(), a.begin() + tz);
+            normalize(r);
+            return;
+        }
+
+        if (b.size() < DIV_NEWTON_THRESHOLD || a.size() - b.size() < DIV_NEWTON_THRESHOLD)
+        {
+            LONGNUM_STATS_TIER(div_schoolbook);
+            divrem_schoolbook(a, b, q, r);
+        }
+        else
+        {
+            LONGNUM_STATS_TIER(div_newton);
+            divrem_newton(a, b, q, r);
+        }
+    }
+
+    limb_vector isqrt(const limb_vector &n)
+    {
+        if (n.size() <= 1)
+        {
+            limb_t v = n.empty() ? 0 : n[0];
+            limb_t x = static_cast<limb_t>(std::sqrt(static_cast<long double>(v)));
+            while (static_cast<dlimb_t>(x) * x > v)
+                --x;
+            while (static_cast<dlimb_t>(x + 1) * (x + 1) <= v)
+                ++x;
+            limb_vector result{x};
+            normalize(result);
+            return result;
+        }
+
+        // Корень из старшей половины битов, затем один шаг Ньютона x = (x + n / x) / 2
+        size_t t = bit_length(n) / 4;
+        limb_vector x = shl(isqrt(shr(n, 2 * t)), t);
+        limb_vector q, r;
+        divrem(n, x, q, r);
+        x = shr(add(x, q), 1);
+
+        // Доводка: x^2 <= n < (x + 1)^2
+        limb_vector s = mul(x, x);
+        while (cmp(s, n) > 0)
+        {
+            s = sub(s, sub(shl(x, 1), one()));
+            x = sub(x, one());
+        }
+        limb_vector next = add(s, add(shl(x, 1), one()));
+        while (cmp(next, n) <= 0)
+        {
+            x = add(x, one());
+            s = next;
+            next = add(s, add(shl(x, 1), one()));
+        }
+        return x;
+    }
+
+} // namespace limbs
@@ -0,0 +1,239 @@
+#include "head.hpp"
+#include "limbs.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
+
+namespace {
+
+    using limbs::limb_t;
+
+    bool same_precision(const LongNumber::term *terms, size_t count)
+    {
+        for (size_t j = 1; j < count; ++j)
+        {
+            if (terms[j].value->get_precision() != terms[0].value->get_precision())
+                return false;
+        }
+        return true;
+    }
+
+    size_t max_size(const LongNumber::term *terms, size_t count)
+    {
+        size_t n = 0;
+        for (size_t j = 0; j < count; ++j)
+            n = std::max(n, terms[j].value->get_limbs().size());
+        return n;
+    }
+
+    // Состояние деления одного члена: нормализованный делитель, его обратная величина,
+    // сдвиг нормализации и текущий остаток
+    struct term_state {
+        const limb_t *x;
+        size_t size;
+        limb_t divisor;
+        limb_t inverse;
+        unsigned shift;
+        limb_t rem;
+        bool plain;
+        bool minus;
+    };
+
+    // Прибавление ±q к 128-битной сумме на позиции i (first — позиция ещё пуста)
+    template <bool First>
+    inline void accumulate_word(limb_t *out, limb_t *high, size_t i, limb_t q, limb_t sign)
+    {
+        // ±q в дополнительном коде: (sign, q ^ sign) + (sign & 1)
+        limbs::dlimb_t t = ((static_cast<limbs::dlimb_t>(sign) << limbs::LIMB_BITS) | (q ^ sign)) + (sign & 1);
+        if (!First)
+            t += (static_cast<limbs::dlimb_t>(high[i]) << limbs::LIMB_BITS) | out[i];
+        out[i] = static_cast<limb_t>(t);
+        high[i] = static_cast<limb_t>(t >> limbs::LIMB_BITS);
+    }
+
+    // Проход по одному члену от старших слов к младшим (до слова c0 включительно):
+    // слова частного со знаком добавляются к 128-битным суммам (high[i], out[i])
+    // без распространения переноса
+    template <bool First>
+    void accumulate_term(limb_t *out, limb_t *high, const term_state &st, size_t c0)
+    {
+        const limb_t *x = st.x;
+        limb_t sign = st.minus ? ~limb_t(0) : 0;
+        if (st.plain)
+        {
+            for (size_t i = c0; i < st.size; ++i)
+                accumulate_word<First>(out, high, i, x[i], sign);
+            return;
+        }
+        if (st.size <= c0)
+            return;
+
+        limb_t rem = st.rem;
+        unsigned s = st.shift;
+        // Делимое сдвигается на s бит "на лету"; двойной сдвиг корректен и при s = 0
+        for (size_t i = st.size - 1; i > 0 && i >= c0; --i)
+        {
+            limb_t u = (x[i] << s) | ((x[i - 1] >> 1) >> (limbs::LIMB_BITS - 1 - s));
+            accumulate_word<First>(out, high, i, limbs::div_preinv(rem, u, st.divisor, st.inverse), sign);
+        }
+        if (c0 == 0)
+            accumulate_word<First>(out, high, 0, limbs::div_preinv(rem, x[0] << s, st.divisor, st.inverse), sign);
+    }
+
+    // Сумма членов одной точности в out (n + 1 слов): каждый член делится прямо
+    // в накапливаемые суммы, перенос распространяется один раз в конце.
+    // При c0 > 0 частные считаются только до слова c0 (заполняются out[c0..n]).
+    // Возвращает true, если сумма отрицательна (в out — её модуль)
+    bool evaluate(limb_t *out, const LongNumber::term *terms, size_t count, size_t n, size_t c0 = 0)
+    {
+        limbs::scratch_scope scratch;
+        // Старшие (знаковые) половины 128-битных сумм по позициям
+        limb_t *high = scratch.alloc(n);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const limbs::limb_vector &x = terms[j].value->get_limbs();
+            unsigned s = __builtin_clzll(terms[j].divisor);
+            term_state st;
+            st.x = x.data();
+            st.size = x.size();
+            st.plain = terms[j].divisor == 1;
+            st.shift = s;
+            st.divisor = terms[j].divisor << s;
+            st.inverse = limbs::reciprocal_word(st.divisor);
+            st.rem = s && !x.empty() ? x.back() >> (limbs::LIMB_BITS - s) : 0;
+            st.minus = terms[j].negate != terms[j].value->get_is_negative();
+            if (j == 0)
+            {
+                size_t top = std::max(st.size, c0);
+                std::fill(out + top, out + n, 0);
+                std::fill(high + top, high + n, 0);
+                accumulate_term<true>(out, high, st, c0);
+            }
+            else
+            {
+                accumulate_term<false>(out, high, st, c0);
+            }
+        }
+
+        __int128 carry = 0;
+        for (size_t i = c0; i < n; ++i)
+        {
+            __int128 acc = static_cast<__int128>(out[i]) + carry;
+            out[i] = static_cast<limb_t>(acc);
+            carry = (acc >> limbs::LIMB_BITS) + static_cast<std::int64_t>(high[i]);
+        }
+        out[n] = static_cast<limb_t>(carry);
+
+        if (carry >= 0)
+            return false;
+        // Дополнительный код -> модуль
+        for (size_t i = c0; i <= n; ++i)
+            out[i] = ~out[i];
+        limbs::add_1(out + c0, out + c0, n + 1 - c0, 1);
+        return true;
+    }
+
+    // Модуль суммы, сдвинутый вправо на shift бит, в out (n + 1 слов); возвращает его длину.
+    // Частные считаются только до двух защитных слов под сдвигом: отброшенные хвосты дают
+    // ошибку меньше count единиц слова c0, и если защитное слово c0 + 1 не 0 и не все единицы,
+    // она не может изменить результат; иначе сумма пересчитывается целиком
+    size_t evaluate_shifted(limb_t *out, const LongNumber::term *terms, size_t count, size_t n,
+                            size_t shift, bool &negative)
+    {
+        size_t ws = shift / limbs::LIMB_BITS;
+        if (ws > n)
+        {
+            negative = false;
+            return 0;
+        }
+        size_t c0 = ws >= 2 ? ws - 2 : 0;
+        negative = evaluate(out, terms, count, n, c0);
+        if (c0 > 0 && (out[c0 + 1] == 0 || out[c0 + 1] == ~limb_t(0)))
+            negative = evaluate(out, terms, count, n);
+
+        size_t len = n + 1 - ws;
+        limbs::rshift(out, out + ws, len, shift % limbs::LIMB_BITS);
+        while (len > 0 && out[len - 1] == 0)
+            --len;
+        negative = negative && len > 0;
+        return len;
+    }
+
+} // end anonymous namespace
+
+void LongNumber::assign_terms(const term *terms, size_t count, int shift)
+{
+    LONGNUM_STATS_OP(expr, max_size(terms, count));
+    if (shift > 0 && same_precision(terms, count))
+    {
+        size_t n = max_size(terms, count);
+        limbs::scratch_scope scratch;
+        limb_t *buffer = scratch.alloc(n + 1);
+        bool negative;
+        size_t len = evaluate_shifted(buffer, terms, count, n, shift, negative);
+        limbs_.assign(buffer, buffer + len);
+        precision_ = terms[0].value->precision_;
+        is_negative_ = negative;
+        return;
+    }
+    if (!same_precision(terms, count))
+    {
+        // Разная точность: члены вычисляются по отдельности и складываются
+        LongNumber sum;
+        for (size_t j = 0; j < count; ++j)
+        {
+            LongNumber part(*terms[j].value);
+            if (terms[j].divisor != 1)
+            {
+                limbs::divrem_1(part.limbs_.data(), part.limbs_.data(), part.limbs_.size(), terms[j].divisor);
+                limbs::normalize(part.limbs_);
+            }
+            sum.add_signed(part, terms[j].negate);
+        }
+        *this = std::move(sum);
+        *this >>= shift;
+        return;
+    }
+
+    size_t n = max_size(terms, count);
+    int precision = terms[0].value->precision_;
+    bool aliased = false;
+    for (size_t j = 0; j < count; ++j)
+        aliased = aliased || terms[j].value == this;
+
+    bool negative;
+    if (aliased)
+    {
+        limbs::scratch_scope scratch;
+        limb_t *buffer = scratch.alloc(n + 1);
+        negative = evaluate(buffer, terms, count, n);
+        limbs_.assign(buffer, buffer + n + 1);
+    }
+    else
+    {
+        limbs_.resize(n + 1);
+        negative = evaluate(limbs_.data(), terms, count, n);
+    }
+    limbs::normalize(limbs_);
+    precision_ = precision;
+    is_negative_ = negative && !limbs_.empty();
+}
+
+void LongNumber::add_terms(const term *terms, size_t count, bool negate, int shift)
+{
+    LONGNUM_STATS_OP(expr, max_size(terms, count));
+    if (!same_precision(terms, count) || terms[0].value->precision_ != precision_)
+    {
+        LongNumber sum;
+        sum.assign_terms(terms, count, shift);
+        add_signed(sum, negate);
+        return;
+    }
+
+    size_t n = max_size(terms, count);
+    limbs::scratch_scope scratch;
+    limb_t *buffer = scratch.alloc(n + 1);
+    bool negative;
+    size_t len = evaluate_shifted(buffer, terms, count, n, shift, negative);
+    add_magnitude(buffer, len, negative != negate);
+}
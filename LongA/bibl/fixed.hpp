@@ -0,0 +1,336 @@
+#ifndef LONGNUM_FIXED_HPP
+#define LONGNUM_FIXED_HPP
+#pragma once
+
+#include "head.hpp"
+#include "limbs.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Число с фиксированной точкой: IntBits бит целой части, FracBits бит после запятой и знак.
+// Хранится в дополнительном коде в std::array из WORDS слов (младшие первыми), значение
+// равно raw / 2^FracBits. Длина известна при компиляции, поэтому циклы по словам
+// развёрнуты полностью (свёртки по индексам), а все операции доступны в constexpr.
+// Округление совпадает с LongNumber: умножение, деление и сдвиг вправо отбрасывают
+// лишние биты модуля. Переполнение целой части не проверяется (значение берётся по модулю).
+//
+// Вычисление при компиляции ограничено лимитом операций компилятора; работа pi() растёт
+// как FracBits^2, и с лимитом GCC по умолчанию (-fconstexpr-ops-limit=2^25) constexpr pi()
+// проходит до FracBits = PI_CONSTEXPR_FRAC_BITS = 3072 (4096 уже нет). Для большей точности
+// при компиляции нужен больший лимит; при выполнении ограничения нет
+template <int IntBits, int FracBits>
+class FixedLong {
+    static_assert(IntBits >= 0 && FracBits >= 0, "FixedLong bit counts must be non-negative");
+
+public:
+    using limb_t = limbs::limb_t;
+    static constexpr std::size_t WORDS = (static_cast<std::size_t>(IntBits) + FracBits + limbs::LIMB_BITS) / limbs::LIMB_BITS;
+    // Наибольшая точность pi() при компиляции с лимитами GCC по умолчанию (см. выше)
+    static constexpr int PI_CONSTEXPR_FRAC_BITS = 3072;
+    using storage = std::array<limb_t, WORDS>;
+
+    constexpr FixedLong() : raw_{} {}
+
+    // Целое число
+    constexpr explicit FixedLong(std::int64_t value) : raw_{}
+    {
+        raw_[0] = value < 0 ? 0 - static_cast<limb_t>(value) : static_cast<limb_t>(value);
+        raw_ = shl_words(raw_, FracBits, indices{});
+        if (value < 0)
+            raw_ = negate_words(raw_, indices{});
+    }
+
+    // Число LongNumber, приведённое к точности FracBits (лишние биты модуля отбрасываются)
+    explicit FixedLong(const LongNumber &number) : raw_{}
+    {
+        const limbs::limb_vector &x = number.get_limbs();
+        int shift = FracBits - number.get_precision();
+        std::size_t ws = static_cast<std::size_t>(shift < 0 ? -shift : shift) / limbs::LIMB_BITS;
+        unsigned bs = static_cast<unsigned>(shift < 0 ? -shift : shift) % limbs::LIMB_BITS;
+        for (std::size_t i = 0; i < WORDS; ++i)
+        {
+            // Слово i результата собирается из слов j и j - 1 (сдвиг влево) или j и j + 1 (вправо)
+            if (shift >= 0)
+            {
+                if (i < ws)
+                    continue;
+                std::size_t j = i - ws;
+                limb_t lo = j < x.size() ? x[j] << bs : 0;
+                limb_t hi = bs && j > 0 && j - 1 < x.size() ? x[j - 1] >> (limbs::LIMB_BITS - bs) : 0;
+                raw_[i] = lo | hi;
+            }
+            else
+            {
+                std::size_t j = i + ws;
+                limb_t lo = j < x.size() ? x[j] >> bs : 0;
+                limb_t hi = bs && j + 1 < x.size() ? x[j + 1] << (limbs::LIMB_BITS - bs) : 0;
+                raw_[i] = lo | hi;
+            }
+        }
+        if (number.get_is_negative())
+            raw_ = negate_words(raw_, indices{});
+    }
+
+    // Число с заданным представлением в дополнительном коде
+    static constexpr FixedLong from_raw(const storage &raw)
+    {
+        FixedLong res;
+        res.raw_ = raw;
+        return res;
+    }
+
+    constexpr const storage &raw() const { return raw_; }
+    constexpr bool is_negative() const { return (raw_[WORDS - 1] >> (limbs::LIMB_BITS - 1)) != 0; }
+
+    LongNumber to_long_number() const
+    {
+        storage m = magnitude();
+        return LongNumber::from_limbs(limbs::limb_vector(m.begin(), m.end()), FracBits, is_negative());
+    }
+
+    std::string to_string() const { return to_long_number().to_string(); }
+
+    constexpr FixedLong operator+(const FixedLong &other) const { return from_raw(add_words(raw_, other.raw_, indices{})); }
+    constexpr FixedLong operator-(const FixedLong &other) const { return from_raw(sub_words(raw_, other.raw_, indices{})); }
+    constexpr FixedLong operator-() const { return from_raw(negate_words(raw_, indices{})); }
+
+    constexpr FixedLong operator*(const FixedLong &other) const
+    {
+        std::array<limb_t, 2 * WORDS> product{};
+        storage a = magnitude();
+        storage b = other.magnitude();
+        mul_words(product, a, b, indices{});
+        storage r = extract_words(product, indices{});
+        return from_raw(is_negative() != other.is_negative() ? negate_words(r, indices{}) : r);
+    }
+
+    // Деление на целое (частное модулей округляется вниз)
+    constexpr FixedLong operator/(std::int64_t divisor) const
+    {
+        if (divisor == 0)
+            throw std::invalid_argument("division by zero.");
+        limb_t d = divisor < 0 ? 0 - static_cast<limb_t>(divisor) : static_cast<limb_t>(divisor);
+        storage r = divrem_words(magnitude(), d, indices{});
+        return from_raw(is_negative() != (divisor < 0) ? negate_words(r, indices{}) : r);
+    }
+
+    // Сдвиги модуля (умножение и деление на 2^shift)
+    constexpr FixedLong operator<<(int shift) const
+    {
+        storage r = shl_words(magnitude(), shift, indices{});
+        return from_raw(is_negative() ? negate_words(r, indices{}) : r);
+    }
+
+    constexpr FixedLong operator>>(int shift) const
+    {
+        storage r = shr_words(magnitude(), shift, indices{});
+        return from_raw(is_negative() ? negate_words(r, indices{}) : r);
+    }
+
+    constexpr FixedLong &operator+=(const FixedLong &other) { return *this = *this + other; }
+    constexpr FixedLong &operator-=(const FixedLong &other) { return *this = *this - other; }
+    constexpr FixedLong &operator*=(const FixedLong &other) { return *this = *this * other; }
+    constexpr FixedLong &operator/=(std::int64_t divisor) { return *this = *this / divisor; }
+    constexpr FixedLong &operator<<=(int shift) { return *this = *this << shift; }
+    constexpr FixedLong &operator>>=(int shift) { return *this = *this >> shift; }
+
+    constexpr bool operator==(const FixedLong &other) const { return raw_ == other.raw_; }
+    constexpr bool operator!=(const FixedLong &other) const { return !(*this == other); }
+    constexpr bool operator<(const FixedLong &other) const { return compare(other) < 0; }
+    constexpr bool operator>(const FixedLong &other) const { return compare(other) > 0; }
+    constexpr bool operator<=(const FixedLong &other) const { return compare(other) <= 0; }
+    constexpr bool operator>=(const FixedLong &other) const { return compare(other) >= 0; }
+
+    // Pi по формуле Бэйли-Борвейна-Плаффа; те же шаги, что в LongNumber::calculate_pi,
+    // поэтому результат совпадает с ним бит в бит. Пригодно для вычисления при компиляции:
+    // частные четырёх делений члена складываются по словам со знаком за один проход
+    // (как в expr.cpp), чтобы уложиться в лимит операций constexpr-вычислителя.
+    // При выполнении точность больше PI_CONSTEXPR_FRAC_BITS считается через
+    // LongNumber::calculate_pi (тот же результат, без развёрнутых циклов длины WORDS)
+    static constexpr FixedLong pi()
+    {
+        if (FracBits == 0)
+            return FixedLong(3);
+        if (!std::is_constant_evaluated() && FracBits > PI_CONSTEXPR_FRAC_BITS)
+            return FixedLong(LongNumber::calculate_pi(FracBits));
+        const storage a0 = FixedLong(4).raw_, b0 = FixedLong(2).raw_, c0 = FixedLong(1).raw_;
+        storage sum{};
+        for (int k = 0; k < FracBits && 4 * k <= FracBits; ++k)
+        {
+            limb_t m = 8ULL * k;
+            limb_t r1 = 0, r4 = 0, r5 = 0, r6 = 0;
+            std::array<__int128, WORDS> acc{};
+            for (std::size_t i = WORDS; i-- > 0;)
+            {
+                acc[i] = static_cast<__int128>(div_step(r1, a0[i], m + 1)) - div_step(r4, b0[i], m + 4)
+                         - div_step(r5, c0[i], m + 5) - div_step(r6, c0[i], m + 6);
+            }
+            storage term{};
+            __int128 carry = 0;
+            for (std::size_t i = 0; i < WORDS; ++i)
+            {
+                __int128 t = acc[i] + carry;
+                term[i] = static_cast<limb_t>(t);
+                carry = t >> limbs::LIMB_BITS;
+            }
+            sum = add_words(sum, shr_words(term, 4 * k, indices{}), indices{});
+        }
+        return from_raw(sum);
+    }
+
+private:
+    using indices = std::make_index_sequence<WORDS>;
+
+    storage raw_;
+
+    constexpr storage magnitude() const
+    {
+        return is_negative() ? negate_words(raw_, indices{}) : raw_;
+    }
+
+    constexpr int compare(const FixedLong &other) const
+    {
+        // Старшее слово сравнивается со знаком, остальные — как беззнаковые
+        auto top = static_cast<std::int64_t>(raw_[WORDS - 1]);
+        auto other_top = static_cast<std::int64_t>(other.raw_[WORDS - 1]);
+        if (top != other_top)
+            return top < other_top ? -1 : 1;
+        for (std::size_t i = WORDS - 1; i-- > 0;)
+        {
+            if (raw_[i] != other.raw_[i])
+                return raw_[i] < other.raw_[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static constexpr limb_t add_carry(limb_t a, limb_t b, limb_t &carry)
+    {
+        limb_t s = a + carry;
+        limb_t c = s < carry;
+        s += b;
+        carry = c + (s < b);
+        return s;
+    }
+
+    static constexpr limb_t sub_borrow(limb_t a, limb_t b, limb_t &borrow)
+    {
+        limb_t d = a - b;
+        limb_t c = a < b;
+        limb_t r = d - borrow;
+        borrow = c + (d < borrow);
+        return r;
+    }
+
+    // acc += a * b + carry, возвращает старшее слово
+    static constexpr limb_t mul_add(limb_t &acc, limb_t a, limb_t b, limb_t carry)
+    {
+        limbs::dlimb_t t = static_cast<limbs::dlimb_t>(a) * b + acc + carry;
+        acc = static_cast<limb_t>(t);
+        return static_cast<limb_t>(t >> limbs::LIMB_BITS);
+    }
+
+    // Ядра над словами: свёртка по индексам I... разворачивает цикл полностью.
+    // Выражения свёртки через запятую вычисляются слева направо, что задаёт цепочку переносов
+    template <std::size_t... I>
+    static constexpr storage add_words(const storage &a, const storage &b, std::index_sequence<I...>)
+    {
+        storage r{};
+        limb_t carry = 0;
+        ((r[I] = add_carry(a[I], b[I], carry)), ...);
+        return r;
+    }
+
+    template <std::size_t... I>
+    static constexpr storage sub_words(const storage &a, const storage &b, std::index_sequence<I...>)
+    {
+        storage r{};
+        limb_t borrow = 0;
+        ((r[I] = sub_borrow(a[I], b[I], borrow)), ...);
+        return r;
+    }
+
+    template <std::size_t... I>
+    static constexpr storage negate_words(const storage &a, std::index_sequence<I...>)
+    {
+        storage r{};
+        limb_t carry = 1;
+        ((r[I] = add_carry(~a[I], 0, carry)), ...);
+        return r;
+    }
+
+    template <std::size_t... I>
+    static constexpr storage shl_words(const storage &a, int shift, std::index_sequence<I...>)
+    {
+        std::size_t ws = static_cast<std::size_t>(shift) / limbs::LIMB_BITS;
+        unsigned bs = static_cast<unsigned>(shift) % limbs::LIMB_BITS;
+        storage r{};
+        ((r[I] = I < ws ? 0
+                        : (a[I - ws] << bs) | (bs && I > ws ? a[I - ws - 1] >> (limbs::LIMB_BITS - bs) : 0)),
+         ...);
+        return r;
+    }
+
+    template <std::size_t... I>
+    static constexpr storage shr_words(const storage &a, int shift, std::index_sequence<I...>)
+    {
+        std::size_t ws = static_cast<std::size_t>(shift) / limbs::LIMB_BITS;
+        unsigned bs = static_cast<unsigned>(shift) % limbs::LIMB_BITS;
+        storage r{};
+        ((r[I] = I + ws >= WORDS ? 0
+                                 : (a[I + ws] >> bs) | (bs && I + ws + 1 < WORDS ? a[I + ws + 1] << (limbs::LIMB_BITS - bs) : 0)),
+         ...);
+        return r;
+    }
+
+    // Строка произведения: p[i..i+WORDS] += a * b (слово p[i + WORDS] ещё не занято)
+    template <std::size_t... J>
+    static constexpr void addmul_row(std::array<limb_t, 2 * WORDS> &p, const storage &a, limb_t b, std::size_t i, std::index_sequence<J...>)
+    {
+        limb_t carry = 0;
+        ((carry = mul_add(p[i + J], a[J], b, carry)), ...);
+        p[i + WORDS] = carry;
+    }
+
+    template <std::size_t... I>
+    static constexpr void mul_words(std::array<limb_t, 2 * WORDS> &p, const storage &a, const storage &b, std::index_sequence<I...>)
+    {
+        (addmul_row(p, a, b[I], I, indices{}), ...);
+    }
+
+    // Слова произведения, сдвинутого вправо на FracBits (сдвиг известен при компиляции)
+    template <std::size_t... I>
+    static constexpr storage extract_words(const std::array<limb_t, 2 * WORDS> &p, std::index_sequence<I...>)
+    {
+        constexpr std::size_t ws = static_cast<std::size_t>(FracBits) / limbs::LIMB_BITS;
+        constexpr unsigned bs = static_cast<unsigned>(FracBits) % limbs::LIMB_BITS;
+        storage r{};
+        if constexpr (bs == 0)
+            ((r[I] = p[I + ws]), ...);
+        else
+            ((r[I] = (p[I + ws] >> bs) | (p[I + ws + 1] << (limbs::LIMB_BITS - bs))), ...);
+        return r;
+    }
+
+    // Деление на слово от старших слов к младшим
+    template <std::size_t... I>
+    static constexpr storage divrem_words(const storage &a, limb_t d, std::index_sequence<I...>)
+    {
+        storage r{};
+        limb_t rem = 0;
+        ((r[WORDS - 1 - I] = div_step(rem, a[WORDS - 1 - I], d)), ...);
+        return r;
+    }
+
+    static constexpr limb_t div_step(limb_t &rem, limb_t u, limb_t d)
+    {
+        limbs::dlimb_t n = (static_cast<limbs::dlimb_t>(rem) << limbs::LIMB_BITS) | u;
+        rem = static_cast<limb_t>(n % d);
+        return static_cast<limb_t>(n / d);
+    }
+};
+
+#endif
@@ -2,31 +2,71 @@
 #define LONGNUM_HPP
 #pragma once
 
+#include "small_vector.hpp"
 #include <vector>
+#include <cstdint>
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <stdexcept>
 #include <string>
 #include <utility>
 
 class LongNumber {
+public:
+    // Член ленивой суммы: ±value / divisor (знак делителя учтён в negate)
+    struct term {
+        const LongNumber *value;
+        std::uint64_t divisor;
+        bool negate;
+    };
+
+    // Ленивая сумма N членов (шаблон выражения), см. определение после класса
+    template <std::size_t N>
+    class [[nodiscard]] expr;
+
+    // Ленивая сумма, сдвинутая вправо на заданное число бит
+    template <std::size_t N>
+    class [[nodiscard]] shifted;
+
+    // Число с фиксированной точкой (bibl/fixed.hpp) строит LongNumber из готовых слов
+    template <int IntBits, int FracBits>
+    friend class FixedLong;
+
 private:
-    std::vector<char> bit_vector_;  // Битовое представление числа
-    int precision_;                 // Количество битов после запятой
-    bool is_negative_;              // Знак числа
+    limbs::limb_vector limbs_;          // Модуль числа, умноженный на 2^precision_ (64-битные слова, младшие первыми)
+    int precision_;                     // Количество битов после запятой
+    bool is_negative_;                  // Знак числа
+
+    LongNumber() : precision_(0), is_negative_(false) {}
+
+    // Создание числа из готового набора слов
+    static LongNumber from_limbs(limbs::limb_vector limbs, int precision, bool is_negative);
 
-    std::string MultStringOnTwo(const std::string &s) const;
-    std::string DivStringOnTwo(const std::string &s) const;
-    std::string SumTwoString(const std::string &num1, const std::string &num2, int type = 0) const;
+    // Прибавление целого числа, заданного модулем и знаком
+    void add_word(std::uint64_t magnitude, bool negative);
+
+    // Прибавление (при negate — вычитание) другого числа на месте
+    void add_signed(const LongNumber &other, bool negate);
+
+    // Прибавление модуля b (bn слов, та же точность) со знаком negative на месте
+    void add_magnitude(const std::uint64_t *b, size_t bn, bool negative);
+
+    // Вычисление суммы членов, сдвинутой вправо на shift бит, в это число / прибавление её к нему
+    void assign_terms(const term *terms, size_t count, int shift = 0);
+    void add_terms(const term *terms, size_t count, bool negate, int shift = 0);
 
 public:
     // Геттеры для доступа к приватным членам
-    const std::vector<char>& get_bit_vector() const { return bit_vector_; }
+    const limbs::limb_vector& get_limbs() const { return limbs_; }
+    std::vector<char> get_bit_vector() const;
     int get_precision() const { return precision_; }
     bool get_is_negative() const { return is_negative_; }
 
     static LongNumber calculate_pi(int precision);
+    // Вычисление pi по формуле Чудновских методом двоичного разбиения (threads — число потоков)
+    static LongNumber calculate_pi_chudnovsky(int precision, unsigned threads = 1);
     // Функция перевода числа из long double в вектор битов
     std::vector<char> convert_to_binary(long double number, int precision, bool is_negative);
 
@@ -39,19 +79,74 @@ public:
     // Конструктор копирования
     LongNumber(const LongNumber &other);
 
+    // Конструктор перемещения
+    LongNumber(LongNumber &&other) noexcept;
+
     // Оператор присваивания
     LongNumber& operator=(const LongNumber &other);
 
+    // Оператор перемещающего присваивания
+    LongNumber& operator=(LongNumber &&other) noexcept;
+
     // Деструктор
     ~LongNumber();
 
+    // Вычисление ленивого выражения (один проход, без промежуточных чисел)
+    template <std::size_t N>
+    LongNumber(const expr<N> &e);
+    template <std::size_t N>
+    LongNumber& operator=(const expr<N> &e);
+    template <std::size_t N>
+    LongNumber& operator+=(const expr<N> &e);
+    template <std::size_t N>
+    LongNumber& operator-=(const expr<N> &e);
+    template <std::size_t N>
+    LongNumber(const shifted<N> &e);
+    template <std::size_t N>
+    LongNumber& operator=(const shifted<N> &e);
+    template <std::size_t N>
+    LongNumber& operator+=(const shifted<N> &e);
+    template <std::size_t N>
+    LongNumber& operator-=(const shifted<N> &e);
+
     // Арифметические операции
-    LongNumber operator+(const LongNumber &other) const;
-    LongNumber operator-() const;
-    LongNumber operator-(const LongNumber &other) const;
-    LongNumber operator*(const LongNumber &other) const;
-    LongNumber operator/(const LongNumber &other) const;
-    LongNumber operator>>(int shift) const;
+    LongNumber operator+(const LongNumber &other) const &;
+    LongNumber operator-() const &;
+    LongNumber operator-(const LongNumber &other) const &;
+    LongNumber operator*(const LongNumber &other) const &;
+    LongNumber operator/(const LongNumber &other) const &;
+    LongNumber operator>>(int shift) const &;
+
+    // Те же операции над временным объектом: результат строится в его памяти
+    LongNumber operator+(const LongNumber &other) &&;
+    LongNumber operator-() &&;
+    LongNumber operator-(const LongNumber &other) &&;
+    LongNumber operator>>(int shift) &&;
+
+    // Составные операции (на месте, без выделения памяти при достаточной ёмкости)
+    LongNumber& operator+=(const LongNumber &other);
+    LongNumber& operator-=(const LongNumber &other);
+    LongNumber& operator*=(const LongNumber &other);
+    LongNumber& operator/=(const LongNumber &other);
+    LongNumber& operator>>=(int shift);
+
+    // Квадратный корень с той же точностью
+    LongNumber sqrt() const;
+
+    // Квадрат числа (то же, что x * x, но вдвое меньше частичных произведений)
+    LongNumber sqr() const;
+
+    // Арифметика с машинным словом (за один проход по числу);
+    // деление без временного объекта даёт ленивый член выражения (вычислять сразу,
+    // не сохраняя в auto, см. expr)
+    LongNumber operator*(std::int64_t value) const &;
+    expr<1> operator/(std::int64_t value) const &;
+    LongNumber operator*(std::int64_t value) &&;
+    LongNumber operator/(std::int64_t value) &&;
+    LongNumber& operator+=(std::int64_t value);
+    LongNumber& operator-=(std::int64_t value);
+    LongNumber& operator*=(std::int64_t value);
+    LongNumber& operator/=(std::int64_t value);
 
     // Операторы сравнения
     bool operator==(const LongNumber &other) const;
@@ -72,10 +167,210 @@ public:
 
     std::string to_string() const;
 
+    // Та же запись потоком: куски цифр передаются в out по мере перевода,
+    // полная строка в памяти не строится
+    void write_decimal(const std::function<void(const char *, size_t)> &out) const;
+
+    // Двоичный формат (bibl/serialize.cpp): заголовок со знаком, точностью и порядком,
+    // затем слова модуля little-endian. Ошибки ввода-вывода и формата — std::runtime_error
+    void save(const std::string &path) const;
+    static LongNumber load(const std::string &path);
+    // Загрузка через отображение файла в память: слова используются на месте без
+    // копирования (страницы читаются по мере обращения), файл не изменяется
+    static LongNumber load_mapped(const std::string &path);
+
     // Дружественная функция для перегрузки оператора <<
     friend std::ostream& operator<<(std::ostream& os, const LongNumber& num);
 };
 
+// Сумма членов вида ±x / d, где x — LongNumber, d — машинное слово, например
+// a / 1 - b / 4 - c / 5. Хранит указатели на операнды, поэтому вычисляется
+// (присваиванием, += или преобразованием в LongNumber) в том же полном выражении.
+// Выражение нельзя сохранять в переменной: в auto e = a / 3 - b * c; член b * c —
+// временный объект, он уничтожается в конце строки, и e указывает на удалённое число.
+// Нужно писать LongNumber e = a / 3 - b * c; (то же для shifted).
+// Если точности членов совпадают, все деления идут одним проходом от старших слов
+// к младшим с общим переносом; иначе члены вычисляются по отдельности
+template <std::size_t N>
+class [[nodiscard]] LongNumber::expr {
+public:
+    term terms[N];
+
+    expr<N> operator-() const
+    {
+        expr<N> result = *this;
+        for (term &t : result.terms)
+            t.negate = !t.negate;
+        return result;
+    }
+
+    std::string to_string() const { return LongNumber(*this).to_string(); }
+};
+
+// Сумма, сдвинутая вправо: e >> s равно LongNumber(e) >> s (модуль усекается), но
+// сдвиг не двигает данные, а слова частных ниже него (кроме двух защитных) не считаются
+template <std::size_t N>
+class [[nodiscard]] LongNumber::shifted {
+public:
+    expr<N> sum;
+    int shift;
+
+    shifted<N> operator-() const { return {-sum, shift}; }
+
+    std::string to_string() const { return LongNumber(*this).to_string(); }
+};
+
+template <std::size_t N>
+LongNumber::LongNumber(const expr<N> &e) : precision_(0), is_negative_(false)
+{
+    assign_terms(e.terms, N);
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator=(const expr<N> &e)
+{
+    assign_terms(e.terms, N);
+    return *this;
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator+=(const expr<N> &e)
+{
+    add_terms(e.terms, N, false);
+    return *this;
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator-=(const expr<N> &e)
+{
+    add_terms(e.terms, N, true);
+    return *this;
+}
+
+template <std::size_t N>
+LongNumber::LongNumber(const shifted<N> &e) : precision_(0), is_negative_(false)
+{
+    assign_terms(e.sum.terms, N, e.shift);
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator=(const shifted<N> &e)
+{
+    assign_terms(e.sum.terms, N, e.shift);
+    return *this;
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator+=(const shifted<N> &e)
+{
+    add_terms(e.sum.terms, N, false, e.shift);
+    return *this;
+}
+
+template <std::size_t N>
+LongNumber &LongNumber::operator-=(const shifted<N> &e)
+{
+    add_terms(e.sum.terms, N, true, e.shift);
+    return *this;
+}
+
+template <std::size_t N, std::size_t M>
+LongNumber::expr<N + M> operator+(const LongNumber::expr<N> &a, const LongNumber::expr<M> &b)
+{
+    LongNumber::expr<N + M> result;
+    std::copy(a.terms, a.terms + N, result.terms);
+    std::copy(b.terms, b.terms + M, result.terms + N);
+    return result;
+}
+
+template <std::size_t N, std::size_t M>
+LongNumber::expr<N + M> operator-(const LongNumber::expr<N> &a, const LongNumber::expr<M> &b)
+{
+    return a + (-b);
+}
+
+template <std::size_t N>
+LongNumber::expr<N + 1> operator+(const LongNumber::expr<N> &a, const LongNumber &b)
+{
+    return a + LongNumber::expr<1>{{{&b, 1, false}}};
+}
+
+template <std::size_t N>
+LongNumber::expr<N + 1> operator-(const LongNumber::expr<N> &a, const LongNumber &b)
+{
+    return a + LongNumber::expr<1>{{{&b, 1, true}}};
+}
+
+template <std::size_t N>
+LongNumber::expr<N + 1> operator+(const LongNumber &a, const LongNumber::expr<N> &b)
+{
+    return LongNumber::expr<1>{{{&a, 1, false}}} + b;
+}
+
+template <std::size_t N>
+LongNumber::expr<N + 1> operator-(const LongNumber &a, const LongNumber::expr<N> &b)
+{
+    return LongNumber::expr<1>{{{&a, 1, false}}} - b;
+}
+
+// Остальные операции над выражением сначала вычисляют его
+template <std::size_t N, class T>
+LongNumber operator*(const LongNumber::expr<N> &a, const T &b)
+{
+    return LongNumber(a) * b;
+}
+
+template <std::size_t N, class T>
+LongNumber operator/(const LongNumber::expr<N> &a, const T &b)
+{
+    return LongNumber(a) / b;
+}
+
+// Сдвиг выражения откладывается до его вычисления
+template <std::size_t N>
+LongNumber::shifted<N> operator>>(const LongNumber::expr<N> &a, int shift)
+{
+    if (shift < 0)
+    {
+        throw std::invalid_argument("shift cannot be negative.");
+    }
+    return {a, shift};
+}
+
+template <std::size_t N>
+LongNumber::shifted<N> operator>>(const LongNumber::shifted<N> &a, int shift)
+{
+    if (shift < 0)
+    {
+        throw std::invalid_argument("shift cannot be negative.");
+    }
+    return {a.sum, a.shift + shift};
+}
+
+template <std::size_t N, class T>
+LongNumber operator+(const LongNumber::shifted<N> &a, const T &b)
+{
+    return LongNumber(a) + b;
+}
+
+template <std::size_t N, class T>
+LongNumber operator-(const LongNumber::shifted<N> &a, const T &b)
+{
+    return LongNumber(a) - b;
+}
+
+template <std::size_t N, class T>
+LongNumber operator*(const LongNumber::shifted<N> &a, const T &b)
+{
+    return LongNumber(a) * b;
+}
+
+template <std::size_t N, class T>
+LongNumber operator/(const LongNumber::shifted<N> &a, const T &b)
+{
+    return LongNumber(a) / b;
+}
+
 // Пользовательский литерал для создания LongNumber (должен быть не-членом класса)
 LongNumber operator"" _longnum(long double number);
 
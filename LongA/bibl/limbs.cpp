@@ -0,0 +1,381 @@
+#include "limbs.hpp"
+#include "scratch.hpp"
+#include <algorithm>
+
+namespace limbs {
+
+    limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        if (n >= SIMD_MIN_SIZE)
+            return simd_add_n(r, a, b, n);
+        limb_t carry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            limb_t s = a[i] + carry;
+            limb_t c1 = s < carry;
+            limb_t t = s + b[i];
+            limb_t c2 = t < s;
+            r[i] = t;
+            carry = c1 | c2;
+        }
+        return carry;
+    }
+
+    limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        if (n >= SIMD_MIN_SIZE)
+            return simd_sub_n(r, a, b, n);
+        limb_t borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            limb_t ai = a[i];
+            limb_t t = ai - b[i];
+            limb_t b1 = ai < b[i];
+            limb_t d = t - borrow;
+            limb_t b2 = t < borrow;
+            r[i] = d;
+            borrow = b1 | b2;
+        }
+        return borrow;
+    }
+
+    limb_t add_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        limb_t carry = b;
+        for (size_t i = 0; i < n; ++i)
+        {
+            limb_t s = a[i] + carry;
+            carry = s < carry;
+            r[i] = s;
+        }
+        return carry;
+    }
+
+    limb_t sub_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        limb_t borrow = b;
+        for (size_t i = 0; i < n; ++i)
+        {
+            limb_t ai = a[i];
+            r[i] = ai - borrow;
+            borrow = ai < borrow;
+        }
+        return borrow;
+    }
+
+    limb_t add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        limb_t carry = add_n(r, a, b, bn);
+        return add_1(r + bn, a + bn, an - bn, carry);
+    }
+
+    limb_t sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        limb_t borrow = sub_n(r, a, b, bn);
+        return sub_1(r + bn, a + bn, an - bn, borrow);
+    }
+
+    int cmp_n(const limb_t *a, const limb_t *b, size_t n)
+    {
+        if (n >= SIMD_MIN_SIZE)
+            return simd_cmp_n(a, b, n);
+        while (n-- > 0)
+        {
+            if (a[n] != b[n])
+                return a[n] > b[n] ? 1 : -1;
+        }
+        return 0;
+    }
+
+    limb_t lshift(limb_t *r, const limb_t *a, size_t n, unsigned cnt)
+    {
+        if (cnt == 0)
+        {
+            std::copy_backward(a, a + n, r + n);
+            return 0;
+        }
+        limb_t out = 0;
+        for (size_t i = n; i-- > 0;)
+        {
+            limb_t ai = a[i];
+            if (i + 1 == n)
+                out = ai >> (LIMB_BITS - cnt);
+            r[i] = (ai << cnt) | (i > 0 ? a[i - 1] >> (LIMB_BITS - cnt) : 0);
+        }
+        return out;
+    }
+
+    limb_t rshift(limb_t *r, const limb_t *a, size_t n, unsigned cnt)
+    {
+        if (cnt == 0)
+        {
+            std::copy(a, a + n, r);
+            return 0;
+        }
+        limb_t out = n > 0 ? a[0] << (LIMB_BITS - cnt) : 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            r[i] = (a[i] >> cnt) | (i + 1 < n ? a[i + 1] << (LIMB_BITS - cnt) : 0);
+        }
+        return out;
+    }
+
+    limb_t submul_1(limb_t *r, const limb_t *a, size_t n, limb_t b)
+    {
+        limb_t borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            dlimb_t p = static_cast<dlimb_t>(a[i]) * b + borrow;
+            limb_t lo = static_cast<limb_t>(p);
+            limb_t ri = r[i];
+            r[i] = ri - lo;
+            borrow = static_cast<limb_t>(p >> LIMB_BITS) + (ri < lo);
+        }
+        return borrow;
+    }
+
+    // Деление на слово через предвычисленную обратную величину (Möller–Granlund):
+    // в цикле только умножения, без 128-битного деления
+    limb_t divrem_1(limb_t *q, const limb_t *a, size_t n, limb_t d)
+    {
+        unsigned s = __builtin_clzll(d);
+        limb_t dn = d << s;
+        limb_t v = reciprocal_word(dn);
+
+        if (n == 0)
+            return 0;
+        // Делимое сдвигается на s бит "на лету", старшие s бит уходят в начальный остаток
+        limb_t r = s ? a[n - 1] >> (LIMB_BITS - s) : 0;
+        for (size_t i = n; i-- > 0;)
+        {
+            limb_t u0 = s ? (a[i] << s) | (i > 0 ? a[i - 1] >> (LIMB_BITS - s) : 0) : a[i];
+            q[i] = div_preinv(r, u0, dn, v);
+        }
+        return r >> s;
+    }
+
+    // Деление "в столбик" по Кнуту (алгоритм D), an >= bn >= 2
+    static void divrem_knuth(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        unsigned s = __builtin_clzll(b[bn - 1]);
+        scratch_scope scratch;
+        limb_t *v = scratch.alloc(bn);
+        limb_t *u = scratch.alloc(an + 1);
+        lshift(v, b, bn, s);
+        u[an] = lshift(u, a, an, s);
+
+        limb_t vh = v[bn - 1];
+        limb_t vl = v[bn - 2];
+        for (size_t j = an - bn + 1; j-- > 0;)
+        {
+            dlimb_t num = (static_cast<dlimb_t>(u[j + bn]) << LIMB_BITS) | u[j + bn - 1];
+            dlimb_t qhat = num / vh;
+            dlimb_t rhat = num % vh;
+            while ((qhat >> LIMB_BITS) != 0 ||
+                   qhat * vl > ((rhat << LIMB_BITS) | u[j + bn - 2]))
+            {
+                --qhat;
+                rhat += vh;
+                if ((rhat >> LIMB_BITS) != 0)
+                    break;
+            }
+            limb_t borrow = submul_1(u + j, v, bn, static_cast<limb_t>(qhat));
+            limb_t top = u[j + bn];
+            u[j + bn] = top - borrow;
+            if (top < borrow)
+            {
+                --qhat;
+                u[j + bn] += add_n(u + j, u + j, v, bn);
+            }
+            q[j] = static_cast<limb_t>(qhat);
+        }
+        rshift(r, u, bn, s);
+    }
+
+    void divrem(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        if (bn == 1)
+        {
+            r[0] = divrem_1(q, a, an, b[0]);
+            return;
+        }
+        divrem_knuth(q, r, a, an, b, bn);
+    }
+
+    void normalize(limb_vector &v)
+    {
+        if (v.size() >= SIMD_MIN_SIZE)
+        {
+            v.resize(simd_normalized_size(v.data(), v.size()));
+            return;
+        }
+        while (!v.empty() && v.back() == 0)
+            v.pop_back();
+    }
+
+    size_t bit_length(const limb_vector &v)
+    {
+        if (v.empty())
+            return 0;
+        return v.size() * LIMB_BITS - __builtin_clzll(v.back());
+    }
+
+    bool test_bit(const limb_vector &v, size_t i)
+    {
+        size_t w = i / LIMB_BITS;
+        return w < v.size() && ((v[w] >> (i % LIMB_BITS)) & 1);
+    }
+
+    void set_bit(limb_vector &v, size_t i)
+    {
+        size_t w = i / LIMB_BITS;
+        if (w >= v.size())
+            v.resize(w + 1, 0);
+        v[w] |= limb_t(1) << (i % LIMB_BITS);
+    }
+
+    int cmp(const limb_vector &a, const limb_vector &b)
+    {
+        if (a.size() != b.size())
+            return a.size() < b.size() ? -1 : 1;
+        return cmp_n(a.data(), b.data(), a.size());
+    }
+
+    // Слово с номером i числа v, сдвинутого влево на shift бит
+    static limb_t shifted_word(const limb_vector &v, size_t shift, size_t i)
+    {
+        size_t ws = shift / LIMB_BITS;
+        unsigned bs = shift % LIMB_BITS;
+        if (i < ws)
+            return 0;
+        size_t j = i - ws;
+        limb_t lo = j < v.size() ? v[j] : 0;
+        if (bs == 0)
+            return lo;
+        limb_t hi = (j > 0 && j - 1 < v.size()) ? v[j - 1] : 0;
+        return (lo << bs) | (hi >> (LIMB_BITS - bs));
+    }
+
+    int cmp_shifted(const limb_vector &a, size_t a_shift, const limb_vector &b, size_t b_shift)
+    {
+        size_t la = a.empty() ? 0 : bit_length(a) + a_shift;
+        size_t lb = b.empty() ? 0 : bit_length(b) + b_shift;
+        if (la != lb)
+            return la < lb ? -1 : 1;
+
+        // Общая часть сдвига на сравнение не влияет; если разница кратна слову,
+        // старшие слова совпадают по положению и сравниваются без сдвигов
+        size_t common = std::min(a_shift, b_shift);
+        a_shift -= common;
+        b_shift -= common;
+        if (a_shift % LIMB_BITS == 0 && b_shift % LIMB_BITS == 0)
+        {
+            size_t overlap = std::min(a.size(), b.size());
+            int c = cmp_n(a.data() + a.size() - overlap, b.data() + b.size() - overlap, overlap);
+            if (c != 0)
+                return c;
+            // У более длинного остались младшие слова, у другого там нули сдвига
+            if (a.size() > overlap)
+                return simd_normalized_size(a.data(), a.size() - overlap) != 0 ? 1 : 0;
+            return simd_normalized_size(b.data(), b.size() - overlap) != 0 ? -1 : 0;
+        }
+
+        size_t n = (la + LIMB_BITS - 1) / LIMB_BITS;
+        while (n-- > 0)
+        {
+            limb_t x = shifted_word(a, a_shift, n);
+            limb_t y = shifted_word(b, b_shift, n);
+            if (x != y)
+                return x < y ? -1 : 1;
+        }
+        return 0;
+    }
+
+    limb_vector shl(const limb_vector &a, size_t bits)
+    {
+        if (a.empty())
+            return {};
+        size_t ws = bits / LIMB_BITS;
+        unsigned bs = bits % LIMB_BITS;
+        limb_vector r(a.size() + ws + 1, 0);
+        r[a.size() + ws] = lshift(r.data() + ws, a.data(), a.size(), bs);
+        normalize(r);
+        return r;
+    }
+
+    limb_vector shr(const limb_vector &a, size_t bits)
+    {
+        size_t ws = bits / LIMB_BITS;
+        if (ws >= a.size())
+            return {};
+        unsigned bs = bits % LIMB_BITS;
+        limb_vector r(a.size() - ws);
+        rshift(r.data(), a.data() + ws, r.size(), bs);
+        normalize(r);
+        return r;
+    }
+
+    limb_vector low_bits(const limb_vector &a, size_t bits)
+    {
+        size_t ws = bits / LIMB_BITS;
+        unsigned bs = bits % LIMB_BITS;
+        if (ws >= a.size())
+            return a;
+        limb_vector r(a.begin(), a.begin() + ws + (bs ? 1 : 0));
+        if (bs)
+            r.back() &= (limb_t(1) << bs) - 1;
+        normalize(r);
+        return r;
+    }
+
+    size_t trailing_zeros(const limb_vector &a)
+    {
+        size_t i = 0;
+        while (i < a.size() && a[i] == 0)
+            ++i;
+        if (i == a.size())
+            return 0;
+        return i * LIMB_BITS + __builtin_ctzll(a[i]);
+    }
+
+    limb_vector add(const limb_vector &a, const limb_vector &b)
+    {
+        const limb_vector &x = a.size() >= b.size() ? a : b;
+        const limb_vector &y = a.size() >= b.size() ? b : a;
+        limb_vector r(x.size() + 1);
+        r[x.size()] = add(r.data(), x.data(), x.size(), y.data(), y.size());
+        normalize(r);
+        return r;
+    }
+
+    limb_vector sub(const limb_vector &a, const limb_vector &b)
+    {
+        limb_vector r(a.size());
+        sub(r.data(), a.data(), a.size(), b.data(), b.size());
+        normalize(r);
+        return r;
+    }
+
+    limb_vector mul(const limb_vector &a, const limb_vector &b)
+    {
+        if (a.empty() || b.empty())
+            return {};
+        const limb_vector &x = a.size() >= b.size() ? a : b;
+        const limb_vector &y = a.size() >= b.size() ? b : a;
+        limb_vector r(x.size() + y.size());
+        mul(r.data(), x.data(), x.size(), y.data(), y.size());
+        normalize(r);
+        return r;
+    }
+
+    limb_vector sqr(const limb_vector &a)
+    {
+        if (a.empty())
+            return {};
+        limb_vector r(2 * a.size());
+        sqr(r.data(), a.data(), a.size());
+        normalize(r);
+        return r;
+    }
+
+} // namespace limbs
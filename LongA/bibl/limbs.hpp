@@ -0,0 +1,155 @@
+#ifndef LONGNUM_LIMBS_HPP
+#define LONGNUM_LIMBS_HPP
+#pragma once
+
+#include "small_vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Низкоуровневые операции над натуральными числами, записанными
+// 64-битными словами (limb), младшее слово первое.
+namespace limbs {
+
+    using limb_t = std::uint64_t;
+    using dlimb_t = unsigned __int128;
+
+    constexpr int LIMB_BITS = 64;
+
+    // Пороги переключения алгоритмов умножения (в словах меньшего операнда)
+    constexpr size_t MUL_KARATSUBA_THRESHOLD = 32;
+    constexpr size_t MUL_TOOM3_THRESHOLD = 256;
+    constexpr size_t MUL_NTT_THRESHOLD = 6144;
+
+    // Пороги для возведения в квадрат: базовый квадрат вдвое дешевле умножения,
+    // поэтому Карацуба выгоднее позже
+    constexpr size_t SQR_KARATSUBA_THRESHOLD = 80;
+    constexpr size_t SQR_TOOM3_THRESHOLD = 256;
+
+    // Короткое произведение в mul_shr используется, если отбрасывается не меньше стольких слов
+    constexpr size_t MUL_SHORT_MIN_WORDS = 4;
+
+    // Порог перехода к делению через обратную величину (Ньютон), в словах
+    constexpr size_t DIV_NEWTON_THRESHOLD = 1024;
+
+    enum class mul_algorithm { automatic, basecase, karatsuba, toom3, ntt };
+
+    // Операции над массивами фиксированной длины (в стиле mpn)
+    limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+    limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+    limb_t add_1(limb_t *r, const limb_t *a, size_t n, limb_t b);
+    limb_t sub_1(limb_t *r, const limb_t *a, size_t n, limb_t b);
+    limb_t add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+    limb_t sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+    int cmp_n(const limb_t *a, const limb_t *b, size_t n);
+
+    // Векторные варианты для длинных массивов (AVX-512, AVX2 или SSE2 — выбор по CPUID
+    // при первом вызове, переменная окружения LONGNUM_SIMD ограничивает его сверху).
+    // add_n, sub_n, cmp_n и normalize переходят на них начиная с SIMD_MIN_SIZE слов
+    constexpr size_t SIMD_MIN_SIZE = 16;
+    limb_t simd_add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+    limb_t simd_sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+    int simd_cmp_n(const limb_t *a, const limb_t *b, size_t n);
+    // Длина массива без старших нулевых слов
+    size_t simd_normalized_size(const limb_t *a, size_t n);
+    // Имя выбранного набора ядер
+    const char *simd_name();
+
+    limb_t lshift(limb_t *r, const limb_t *a, size_t n, unsigned cnt);
+    limb_t rshift(limb_t *r, const limb_t *a, size_t n, unsigned cnt);
+
+    // mul_1, addmul_1, mul_basecase, sqr_basecase и mulhigh_basecase выбирают реализацию по CPUID при первом вызове:
+    // mulx/adcx/adox (BMI2 + ADX) или переносимую на unsigned __int128
+    // (переменная окружения LONGNUM_MUL_BASECASE=generic принудительно выбирает переносимую)
+    limb_t mul_1(limb_t *r, const limb_t *a, size_t n, limb_t b);
+    limb_t addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t b);
+    limb_t submul_1(limb_t *r, const limb_t *a, size_t n, limb_t b);
+    void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+    // Имя выбранной реализации базового умножения
+    const char *mul_basecase_name();
+    // Квадрат r[0..2n) = a[0..n)^2: симметричные произведения считаются один раз
+    void sqr_basecase(limb_t *r, const limb_t *a, size_t n);
+    void sqr(limb_t *r, const limb_t *a, size_t n);
+    // Столбцы [c0, an + bn) суммы только тех a[i] * b[j], где i + j >= c0 (an + bn - c0 слов)
+    void mulhigh_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0);
+    // Умножение с автоматическим выбором алгоритма (an >= bn >= 1, r длины an + bn);
+    // при a == b, an == bn вызывается sqr
+    void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+    // Умножение заданным алгоритмом на верхнем уровне рекурсии (для замеров)
+    void mul_with(mul_algorithm algorithm, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+    // Умножение через теоретико-числовое преобразование по трём простым модулям
+    void mul_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+    limb_t divrem_1(limb_t *q, const limb_t *a, size_t n, limb_t d);
+
+    // Обратная величина нормализованного (старший бит = 1) делителя-слова: floor((2^128 - 1) / d) - 2^64
+    inline limb_t reciprocal_word(limb_t d)
+    {
+        return static_cast<limb_t>(((static_cast<dlimb_t>(~d) << LIMB_BITS) | ~limb_t(0)) / d);
+    }
+
+    // Деление (r, u) на нормализованный d с обратной величиной v (Möller–Granlund), r < d;
+    // возвращает частное, в r остаётся остаток
+    inline limb_t div_preinv(limb_t &r, limb_t u, limb_t d, limb_t v)
+    {
+        dlimb_t qq = static_cast<dlimb_t>(v) * r + ((static_cast<dlimb_t>(r) << LIMB_BITS) | u);
+        limb_t q1 = static_cast<limb_t>(qq >> LIMB_BITS) + 1;
+        limb_t q0 = static_cast<limb_t>(qq);
+        limb_t rr = u - q1 * d;
+        if (rr > q0)
+        {
+            --q1;
+            rr += d;
+        }
+        if (rr >= d)
+        {
+            ++q1;
+            rr -= d;
+        }
+        r = rr;
+        return q1;
+    }
+    void divrem(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+    // Операции над нормализованными векторами (без старших нулевых слов)
+    void normalize(limb_vector &v);
+    size_t bit_length(const limb_vector &v);
+    bool test_bit(const limb_vector &v, size_t i);
+    void set_bit(limb_vector &v, size_t i);
+
+    int cmp(const limb_vector &a, const limb_vector &b);
+    int cmp_shifted(const limb_vector &a, size_t a_shift, const limb_vector &b, size_t b_shift);
+
+    limb_vector shl(const limb_vector &a, size_t bits);
+    limb_vector shr(const limb_vector &a, size_t bits);
+    limb_vector low_bits(const limb_vector &a, size_t bits);
+    size_t trailing_zeros(const limb_vector &a);
+    limb_vector add(const limb_vector &a, const limb_vector &b);
+    limb_vector sub(const limb_vector &a, const limb_vector &b);
+    limb_vector mul(const limb_vector &a, const limb_vector &b);
+    limb_vector sqr(const limb_vector &a);
+    // floor(a * b / 2^bits): младшие частичные произведения не вычисляются (короткое
+    // произведение с двумя словами запаса), при риске ошибки переноса — точный пересчёт
+    limb_vector mul_shr(const limb_vector &a, const limb_vector &b, size_t bits);
+    // Деление с остатком: столбиком для малых размеров, через обратную величину для больших
+    void divrem(const limb_vector &a, const limb_vector &b, limb_vector &q, limb_vector &r);
+    // Целая часть квадратного корня
+    limb_vector isqrt(const limb_vector &n);
+
+    // Перевод в десятичную систему "разделяй и властвуй" по степеням 10^(19 * 2^k)
+    const limb_vector &power_of_ten(size_t level);
+    limb_vector power_of_five(size_t exponent);
+    // Десятичная запись; при width > 0 дополняется нулями слева до width цифр
+    std::string to_decimal(const limb_vector &v, size_t width = 0);
+    // То же потоком: цифры передаются в out кусками слева направо по мере перевода,
+    // целиком строка не строится
+    using digit_sink = std::function<void(const char *digits, size_t n)>;
+    void write_decimal(const limb_vector &v, size_t width, const digit_sink &out);
+    // Число по строке десятичных цифр (без знака и точки)
+    limb_vector from_decimal(const char *digits, size_t n);
+
+} // namespace limbs
+
+#endif
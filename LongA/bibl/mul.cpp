@@ -0,0 +1,474 @@
+#include "limbs.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
+#include <algorithm>
+
+namespace limbs {
+
+    namespace {
+
+        void mul_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n);
+        void sqr_n(limb_t *r, const limb_t *a, size_t n);
+        void mulhigh(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0);
+
+        // r = |x - y| (xn >= yn, xn слов), возвращает true, если x < y
+        bool abs_diff(limb_t *r, const limb_t *x, size_t xn, const limb_t *y, size_t yn)
+        {
+            bool x_less;
+            size_t top = xn;
+            while (top > yn && x[top - 1] == 0)
+                --top;
+            if (top > yn)
+                x_less = false;
+            else
+                x_less = cmp_n(x, y, yn) < 0;
+
+            if (!x_less)
+            {
+                sub(r, x, xn, y, yn);
+            }
+            else
+            {
+                sub_n(r, y, x, yn);
+                std::fill(r + yn, r + xn, 0);
+            }
+            return x_less;
+        }
+
+        // Карацуба: r[0..2n) = a[0..n) * b[0..n)
+        void mul_karatsuba(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            size_t l = n / 2;
+            size_t h = n - l;
+            const limb_t *a0 = a, *a1 = a + l;
+            const limb_t *b0 = b, *b1 = b + l;
+
+            mul_n(r, a0, b0, l);
+            mul_n(r + 2 * l, a1, b1, h);
+
+            scratch_scope scratch;
+            limb_t *da = scratch.alloc(h);
+            limb_t *db = scratch.alloc(h);
+            limb_t *zm = scratch.alloc(2 * h);
+            limb_t *mid = scratch.alloc(2 * h + 1);
+            bool sa = abs_diff(da, a1, h, a0, l);
+            bool sb = abs_diff(db, b1, h, b0, l);
+            mul_n(zm, da, db, h);
+
+            // mid = a0*b0 + a1*b1 -/+ |a1 - a0| * |b1 - b0|
+            std::copy(r + 2 * l, r + 2 * n, mid);
+            mid[2 * h] = add(mid, mid, 2 * h, r, 2 * l);
+            if (sa == sb)
+                sub(mid, mid, 2 * h + 1, zm, 2 * h);
+            else
+                add(mid, mid, 2 * h + 1, zm, 2 * h);
+
+            size_t mn = 2 * h + 1;
+            while (mn > 0 && mid[mn - 1] == 0)
+                --mn;
+            add(r + l, r + l, 2 * n - l, mid, mn);
+        }
+
+        // Квадрат по Карацубе: 2 * a0 * a1 = a0^2 + a1^2 - (a1 - a0)^2, три квадрата вместо трёх умножений
+        void sqr_karatsuba(limb_t *r, const limb_t *a, size_t n)
+        {
+            size_t l = n / 2;
+            size_t h = n - l;
+            const limb_t *a0 = a, *a1 = a + l;
+
+            sqr_n(r, a0, l);
+            sqr_n(r + 2 * l, a1, h);
+
+            scratch_scope scratch;
+            limb_t *da = scratch.alloc(h);
+            limb_t *zm = scratch.alloc(2 * h);
+            limb_t *mid = scratch.alloc(2 * h + 1);
+            abs_diff(da, a1, h, a0, l);
+            sqr_n(zm, da, h);
+
+            // mid = a0^2 + a1^2 - (a1 - a0)^2 >= 0
+            std::copy(r + 2 * l, r + 2 * n, mid);
+            mid[2 * h] = add(mid, mid, 2 * h, r, 2 * l);
+            sub(mid, mid, 2 * h + 1, zm, 2 * h);
+
+            size_t mn = 2 * h + 1;
+            while (mn > 0 && mid[mn - 1] == 0)
+                --mn;
+            add(r + l, r + l, 2 * n - l, mid, mn);
+        }
+
+        // Число со знаком для промежуточных значений Toom-3
+        struct signed_vector {
+            limb_vector mag;
+            bool neg = false;
+        };
+
+        signed_vector make_signed(limb_vector mag, bool neg)
+        {
+            normalize(mag);
+            bool is_neg = neg && !mag.empty();
+            return signed_vector{std::move(mag), is_neg};
+        }
+
+        signed_vector sadd(const signed_vector &x, const signed_vector &y)
+        {
+            if (x.neg == y.neg)
+                return make_signed(add(x.mag, y.mag), x.neg);
+            int c = cmp(x.mag, y.mag);
+            if (c == 0)
+                return {};
+            if (c > 0)
+                return make_signed(sub(x.mag, y.mag), x.neg);
+            return make_signed(sub(y.mag, x.mag), y.neg);
+        }
+
+        signed_vector ssub(const signed_vector &x, const signed_vector &y)
+        {
+            return sadd(x, make_signed(y.mag, !y.neg));
+        }
+
+        signed_vector sshl1(const signed_vector &x)
+        {
+            return make_signed(shl(x.mag, 1), x.neg);
+        }
+
+        signed_vector smul(const signed_vector &x, const signed_vector &y)
+        {
+            return make_signed(mul(x.mag, y.mag), x.neg != y.neg);
+        }
+
+        signed_vector ssqr(const signed_vector &x)
+        {
+            return make_signed(sqr(x.mag), false);
+        }
+
+        signed_vector sdiv_exact(const signed_vector &x, limb_t d)
+        {
+            limb_vector q(x.mag.size());
+            divrem_1(q.data(), x.mag.data(), x.mag.size(), d);
+            return make_signed(std::move(q), x.neg);
+        }
+
+        signed_vector part(const limb_t *p, size_t n)
+        {
+            return make_signed(limb_vector(p, p + n), false);
+        }
+
+        // Значения многочлена x0 + x1 t + x2 t^2 (части длины k) в точках 0, 1, -1, -2, inf
+        struct toom3_points {
+            signed_vector p0, p1, pm1, pm2, pinf;
+        };
+
+        toom3_points toom3_evaluate(const limb_t *x, size_t n, size_t k)
+        {
+            signed_vector x0 = part(x, k), x1 = part(x + k, k), x2 = part(x + 2 * k, n - 2 * k);
+            signed_vector t = sadd(x0, x2);
+            toom3_points v;
+            v.p1 = sadd(t, x1);
+            v.pm1 = ssub(t, x1);
+            v.pm2 = ssub(sshl1(sadd(v.pm1, x2)), x0);
+            v.p0 = std::move(x0);
+            v.pinf = std::move(x2);
+            return v;
+        }
+
+        // Интерполяция по Bodrato и сборка r[0..2n) из значений произведения в точках
+        void toom3_interpolate(limb_t *r, size_t n, size_t k, signed_vector r0, signed_vector r1,
+                               signed_vector rm1, signed_vector rm2, signed_vector rinf)
+        {
+            signed_vector r3 = sdiv_exact(ssub(rm2, r1), 3);
+            r1 = ssub(r1, rm1);
+            r1 = make_signed(shr(r1.mag, 1), r1.neg);
+            signed_vector r2 = ssub(rm1, r0);
+            r3 = ssub(r2, r3);
+            r3 = make_signed(shr(r3.mag, 1), r3.neg);
+            r3 = sadd(r3, sshl1(rinf));
+            r2 = ssub(sadd(r2, r1), rinf);
+            r1 = ssub(r1, r3);
+
+            std::fill(r, r + 2 * n, 0);
+            const signed_vector *coeffs[] = {&r0, &r1, &r2, &r3, &rinf};
+            for (size_t i = 0; i < 5; ++i)
+            {
+                const limb_vector &c = coeffs[i]->mag;
+                if (!c.empty())
+                    add(r + i * k, r + i * k, 2 * n - i * k, c.data(), c.size());
+            }
+        }
+
+        // Toom-Cook 3 (точки 0, 1, -1, -2, inf, интерполяция по Bodrato)
+        void mul_toom3(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            size_t k = (n + 2) / 3;
+            toom3_points va = toom3_evaluate(a, n, k);
+            toom3_points vb = toom3_evaluate(b, n, k);
+            toom3_interpolate(r, n, k, smul(va.p0, vb.p0), smul(va.p1, vb.p1), smul(va.pm1, vb.pm1),
+                              smul(va.pm2, vb.pm2), smul(va.pinf, vb.pinf));
+        }
+
+        // Квадрат по Toom-3: одно вычисление значений и пять квадратов
+        void sqr_toom3(limb_t *r, const limb_t *a, size_t n)
+        {
+            size_t k = (n + 2) / 3;
+            toom3_points va = toom3_evaluate(a, n, k);
+            toom3_interpolate(r, n, k, ssqr(va.p0), ssqr(va.p1), ssqr(va.pm1), ssqr(va.pm2), ssqr(va.pinf));
+        }
+
+        void mul_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            if (n < MUL_KARATSUBA_THRESHOLD)
+                mul_basecase(r, a, n, b, n);
+            else if (n < MUL_TOOM3_THRESHOLD)
+                mul_karatsuba(r, a, b, n);
+            else
+                mul_toom3(r, a, b, n);
+        }
+
+        void sqr_n(limb_t *r, const limb_t *a, size_t n)
+        {
+            if (n < SQR_KARATSUBA_THRESHOLD)
+                sqr_basecase(r, a, n);
+            else if (n < SQR_TOOM3_THRESHOLD)
+                sqr_karatsuba(r, a, n);
+            else
+                sqr_toom3(r, a, n);
+        }
+
+        // Короткое произведение n x n слов (схема Малдерса): части режутся на l <= n / 2
+        // слов так, чтобы a0 * b0 целиком лежало ниже c0 и отбрасывалось; a1 * b1
+        // считается полностью (или рекурсивно), a1 * b0 и a0 * b1 — рекурсивно короткими
+        void mulhigh_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, size_t c0)
+        {
+            if (c0 == 0)
+            {
+                mul_n(r, a, b, n);
+                return;
+            }
+            if (n < MUL_KARATSUBA_THRESHOLD)
+            {
+                mulhigh_basecase(r, a, n, b, n, c0);
+                return;
+            }
+            // Младшие части по l ~ 0.3 n слов (оптимум схемы для Карацубы), но не больше
+            // (c0 + 1) / 2, чтобы a0 * b0 лежало ниже среза
+            size_t l = std::min(3 * n / 10 + 1, (c0 + 1) / 2);
+            size_t h = n - l;
+            size_t rn = 2 * n - c0;
+            scratch_scope scratch;
+            if (l < n / 8)
+            {
+                // Срез слишком низко: экономить нечего
+                limb_t *t = scratch.alloc(2 * n);
+                mul_n(t, a, b, n);
+                std::copy(t + c0, t + 2 * n, r);
+                return;
+            }
+
+            const limb_t *a0 = a, *a1 = a + l;
+            const limb_t *b0 = b, *b1 = b + l;
+            if (c0 <= 2 * l)
+            {
+                std::fill(r, r + 2 * l - c0, 0);
+                mul_n(r + 2 * l - c0, a1, b1, h);
+            }
+            else
+            {
+                mulhigh_n(r, a1, b1, h, c0 - 2 * l);
+            }
+
+            // Перекрёстные произведения h x l: до среза c0 - l дотягиваются только старшие
+            // ma = n + l - 1 - c0 слов длинной части
+            if (n + l <= c0 + 1)
+                return;
+            size_t off = c0 - 2 * l + 1;
+            size_t ma = h - off;
+            size_t tn = ma + 1;
+            limb_t *t = scratch.alloc(tn);
+            const limb_t *pairs[2][2] = {{a1 + off, b0}, {b1 + off, a0}};
+            for (const auto &pair : pairs)
+            {
+                if (ma >= l)
+                    mulhigh(t, pair[0], ma, pair[1], l, l - 1);
+                else
+                    mulhigh(t, pair[1], l, pair[0], ma, l - 1);
+                add(r, r, rn, t, std::min(tn, rn));
+            }
+        }
+
+        // Короткое произведение an x bn (an >= bn): столбцы [c0, an + bn) суммы всех
+        // a[i] * b[j] с i + j >= c0. Несбалансированные множители режутся на куски по bn слов
+        void mulhigh(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, size_t c0)
+        {
+            if (bn < MUL_KARATSUBA_THRESHOLD)
+            {
+                mulhigh_basecase(r, a, an, b, bn, c0);
+                return;
+            }
+            size_t rn = an + bn - c0;
+            scratch_scope scratch;
+            if (an <= bn + bn / 4)
+            {
+                limb_t *pad = scratch.alloc_zero(an);
+                limb_t *t = scratch.alloc(2 * an - c0);
+                std::copy(b, b + bn, pad);
+                mulhigh_n(t, a, pad, an, c0);
+                std::copy(t, t + rn, r);
+                return;
+            }
+
+            std::fill(r, r + rn, 0);
+            limb_t *t = scratch.alloc(2 * bn);
+            for (size_t i = 0; i < an; i += bn)
+            {
+                size_t len = std::min(bn, an - i);
+                // Кусок a[i..i + len) * b занимает столбцы [i, i + len + bn)
+                if (i + len + bn < c0 + 2)
+                    continue;
+                size_t cut = c0 > i ? c0 - i : 0;
+                size_t tn = len + bn - cut;
+                if (len < bn)
+                    mulhigh(t, b, bn, a + i, len, cut);
+                else
+                    mulhigh_n(t, a + i, b, bn, cut);
+                size_t pos = i + cut - c0;
+                add(r + pos, r + pos, rn - pos, t, std::min(tn, rn - pos));
+            }
+        }
+
+    } // end anonymous namespace
+
+    void sqr(limb_t *r, const limb_t *a, size_t n)
+    {
+#if LONGNUM_STATS
+        if (n < SQR_KARATSUBA_THRESHOLD)
+            LONGNUM_STATS_TIER(sqr_basecase);
+        else if (n < SQR_TOOM3_THRESHOLD)
+            LONGNUM_STATS_TIER(sqr_karatsuba);
+        else if (n < MUL_NTT_THRESHOLD)
+            LONGNUM_STATS_TIER(sqr_toom3);
+        else
+            LONGNUM_STATS_TIER(sqr_ntt);
+#endif
+        if (n >= MUL_NTT_THRESHOLD)
+            mul_ntt(r, a, n, a, n);
+        else
+            sqr_n(r, a, n);
+    }
+
+    void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        if (a == b && an == bn)
+        {
+            sqr(r, a, an);
+            return;
+        }
+#if LONGNUM_STATS
+        if (bn < MUL_KARATSUBA_THRESHOLD)
+            LONGNUM_STATS_TIER(mul_basecase);
+        else if (bn < MUL_TOOM3_THRESHOLD)
+            LONGNUM_STATS_TIER(mul_karatsuba);
+        else if (bn < MUL_NTT_THRESHOLD)
+            LONGNUM_STATS_TIER(mul_toom3);
+        else
+            LONGNUM_STATS_TIER(mul_ntt);
+#endif
+        if (bn < MUL_KARATSUBA_THRESHOLD)
+        {
+            mul_basecase(r, a, an, b, bn);
+            return;
+        }
+        if (bn >= MUL_NTT_THRESHOLD)
+        {
+            mul_ntt(r, a, an, b, bn);
+            return;
+        }
+        if (an == bn)
+        {
+            mul_n(r, a, b, an);
+            return;
+        }
+
+        // Несбалансированные операнды: режем a на куски длины bn
+        std::fill(r, r + an + bn, 0);
+        scratch_scope scratch;
+        limb_t *t = scratch.alloc(2 * bn);
+        for (size_t i = 0; i < an; i += bn)
+        {
+            size_t len = std::min(bn, an - i);
+            if (len == bn)
+                mul_n(t, a + i, b, bn);
+            else
+                mul(t, b, bn, a + i, len);
+            add(r + i, r + i, an + bn - i, t, len + bn);
+        }
+    }
+
+    void mul_with(mul_algorithm algorithm, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        switch (algorithm)
+        {
+        case mul_algorithm::basecase:
+            mul_basecase(r, a, an, b, bn);
+            return;
+        case mul_algorithm::karatsuba:
+            if (an == bn && an >= 2)
+            {
+                mul_karatsuba(r, a, b, an);
+                return;
+            }
+            break;
+        case mul_algorithm::toom3:
+            if (an == bn && an >= 3)
+            {
+                mul_toom3(r, a, b, an);
+                return;
+            }
+            break;
+        case mul_algorithm::ntt:
+            mul_ntt(r, a, an, b, bn);
+            return;
+        case mul_algorithm::automatic:
+            break;
+        }
+        mul(r, a, an, b, bn);
+    }
+
+    limb_vector mul_shr(const limb_vector &a, const limb_vector &b, size_t bits)
+    {
+        const limb_vector &x = a.size() >= b.size() ? a : b;
+        const limb_vector &y = a.size() >= b.size() ? b : a;
+        size_t an = x.size(), bn = y.size();
+        size_t k = bits / LIMB_BITS;
+        unsigned s = bits % LIMB_BITS;
+        bool square = &a == &b || (an == bn && a.data() == b.data());
+
+        // Короткое произведение имеет смысл, если отбрасывается хотя бы несколько слов;
+        // большие квадраты выгоднее считать через sqr, а начиная с Тоома-3 выигрыша нет
+        bool big_square = square && bn >= SQR_KARATSUBA_THRESHOLD;
+        if (bn == 0 || k < MUL_SHORT_MIN_WORDS || k + 2 > an + bn || big_square || bn >= MUL_TOOM3_THRESHOLD)
+            return shr(square ? sqr(x) : mul(x, y), bits);
+
+        // Столбцы от c0 = k - 2: два слова запаса под перенос от отброшенных произведений
+        LONGNUM_STATS_TIER(mul_short);
+        size_t c0 = k - 2;
+        size_t n = an;
+        scratch_scope scratch;
+        size_t rn = an + bn - c0;
+        limb_t *r = scratch.alloc(rn);
+        mulhigh(r, x.data(), an, y.data(), bn, c0);
+
+        // Отброшенная сумма меньше 4 n^2 + 4 единиц слова k - 1. Если биты [k - 1, k + s)
+        // настолько близки к переполнению, что она могла дать перенос в ответ, считаем точно
+        dlimb_t window = r[1] | (static_cast<dlimb_t>(r[2] & ((limb_t(1) << s) - 1)) << LIMB_BITS);
+        dlimb_t limit = (static_cast<dlimb_t>(1) << (LIMB_BITS + s)) - 1;
+        dlimb_t error = 4 * static_cast<dlimb_t>(n) * n + 4;
+        if (window > limit - error)
+            return shr(square ? sqr(x) : mul(x, y), bits);
+
+        limb_vector high(rn - 2);
+        rshift(high.data(), r + 2, rn - 2, s);
+        normalize(high);
+        return high;
+    }
+
+} // namespace limbs
@@ -0,0 +1,247 @@
+#include "limbs.hpp"
+#include "scratch.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace limbs {
+
+    namespace {
+
+        // Простые вида c * 2^50 + 1 и их первообразные корни
+        struct ntt_prime {
+            limb_t p;
+            limb_t g;
+        };
+
+        constexpr ntt_prime NTT_PRIMES[3] = {
+            {4601552919265804289ULL, 3},
+            {4546383823830515713ULL, 10},
+            {4522739925786820609ULL, 37},
+        };
+
+        constexpr int NTT_MAX_LOG = 50;
+
+        limb_t pow_mod(limb_t base, limb_t e, limb_t p)
+        {
+            dlimb_t result = 1, b = base % p;
+            while (e)
+            {
+                if (e & 1)
+                    result = result * b % p;
+                b = b * b % p;
+                e >>= 1;
+            }
+            return static_cast<limb_t>(result);
+        }
+
+        // Арифметика Монтгомери по модулю p < 2^62
+        class montgomery {
+        public:
+            explicit montgomery(limb_t p) : p_(p)
+            {
+                limb_t inv = p;
+                for (int i = 0; i < 6; ++i)
+                    inv *= 2 - p * inv;
+                ninv_ = ~inv + 1;
+                limb_t r1 = (~p + 1) % p;
+                r2_ = static_cast<limb_t>(static_cast<dlimb_t>(r1) * r1 % p);
+            }
+
+            limb_t p() const { return p_; }
+
+            limb_t reduce(dlimb_t t) const
+            {
+                limb_t m = static_cast<limb_t>(t) * ninv_;
+                limb_t u = static_cast<limb_t>((t + static_cast<dlimb_t>(m) * p_) >> LIMB_BITS);
+                return u >= p_ ? u - p_ : u;
+            }
+
+            limb_t mul(limb_t a, limb_t b) const { return reduce(static_cast<dlimb_t>(a) * b); }
+            limb_t to(limb_t x) const { return mul(x, r2_); }
+            limb_t from(limb_t x) const { return reduce(x); }
+
+            limb_t add(limb_t a, limb_t b) const
+            {
+                limb_t s = a + b;
+                return s >= p_ ? s - p_ : s;
+            }
+
+            limb_t sub(limb_t a, limb_t b) const
+            {
+                return a >= b ? a - b : a + p_ - b;
+            }
+
+        private:
+            limb_t p_;
+            limb_t ninv_;
+            limb_t r2_;
+        };
+
+        struct ntt_context {
+            montgomery mont[3] = {montgomery(NTT_PRIMES[0].p), montgomery(NTT_PRIMES[1].p),
+                                  montgomery(NTT_PRIMES[2].p)};
+            // Константы для восстановления по китайской теореме об остатках (Гарнер)
+            limb_t inv_p0_mod_p1;   // p0^-1 mod p1, в форме Монтгомери
+            limb_t inv_p0p1_mod_p2; // (p0 * p1)^-1 mod p2, в форме Монтгомери
+            limb_t p0_mod_p2;       // p0 mod p2, в форме Монтгомери
+
+            ntt_context()
+            {
+                limb_t p0 = NTT_PRIMES[0].p, p1 = NTT_PRIMES[1].p, p2 = NTT_PRIMES[2].p;
+                inv_p0_mod_p1 = mont[1].to(pow_mod(p0 % p1, p1 - 2, p1));
+                limb_t p0p1 = static_cast<limb_t>(static_cast<dlimb_t>(p0 % p2) * (p1 % p2) % p2);
+                inv_p0p1_mod_p2 = mont[2].to(pow_mod(p0p1, p2 - 2, p2));
+                p0_mod_p2 = mont[2].to(p0 % p2);
+            }
+        };
+
+        const ntt_context &context()
+        {
+            static const ntt_context ctx;
+            return ctx;
+        }
+
+        // Таблица степеней корня порядка n: w^0 .. w^(n/2 - 1), в форме Монтгомери
+        std::vector<limb_t> root_table(const montgomery &m, limb_t g, size_t n, bool inverse)
+        {
+            limb_t p = m.p();
+            limb_t w = pow_mod(g, (p - 1) / n, p);
+            if (inverse)
+                w = pow_mod(w, p - 2, p);
+            std::vector<limb_t> roots(std::max<size_t>(n / 2, 1));
+            limb_t wm = m.to(w);
+            roots[0] = m.to(1);
+            for (size_t j = 1; j < roots.size(); ++j)
+                roots[j] = m.mul(roots[j - 1], wm);
+            return roots;
+        }
+
+        // Прямое преобразование (DIF): естественный порядок -> бит-реверсный
+        void forward(limb_t *a, size_t n, const montgomery &m, const std::vector<limb_t> &roots)
+        {
+            for (size_t len = n / 2; len >= 1; len >>= 1)
+            {
+                size_t stride = n / (2 * len);
+                for (size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (size_t j = 0; j < len; ++j)
+                    {
+                        limb_t u = a[i + j];
+                        limb_t v = a[i + j + len];
+                        a[i + j] = m.add(u, v);
+                        a[i + j + len] = m.mul(m.sub(u, v), roots[j * stride]);
+                    }
+                }
+            }
+        }
+
+        // Обратное преобразование (DIT): бит-реверсный порядок -> естественный
+        void inverse(limb_t *a, size_t n, const montgomery &m, const std::vector<limb_t> &roots)
+        {
+            for (size_t len = 1; len < n; len <<= 1)
+            {
+                size_t stride = n / (2 * len);
+                for (size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (size_t j = 0; j < len; ++j)
+                    {
+                        limb_t u = a[i + j];
+                        limb_t v = m.mul(a[i + j + len], roots[j * stride]);
+                        a[i + j] = m.add(u, v);
+                        a[i + j + len] = m.sub(u, v);
+                    }
+                }
+            }
+        }
+
+        // Свёртка a * b по модулю одного простого в fa (n слов), результат в обычной форме.
+        // Для квадрата (b совпадает с a) прямое преобразование одно
+        void convolve(limb_t *fa, const limb_t *a, size_t an, const limb_t *b, size_t bn,
+                      size_t n, const montgomery &m, limb_t g)
+        {
+            bool square = a == b && an == bn;
+            std::fill(fa, fa + n, 0);
+            for (size_t i = 0; i < an; ++i)
+                fa[i] = m.to(a[i]);
+
+            std::vector<limb_t> roots = root_table(m, g, n, false);
+            forward(fa, n, m, roots);
+            if (square)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    fa[i] = m.mul(fa[i], fa[i]);
+            }
+            else
+            {
+                scratch_scope scratch;
+                limb_t *fb = scratch.alloc_zero(n);
+                for (size_t i = 0; i < bn; ++i)
+                    fb[i] = m.to(b[i]);
+                forward(fb, n, m, roots);
+                for (size_t i = 0; i < n; ++i)
+                    fa[i] = m.mul(fa[i], fb[i]);
+            }
+
+            roots = root_table(m, g, n, true);
+            inverse(fa, n, m, roots);
+
+            limb_t p = m.p();
+            limb_t n_inv = m.to(pow_mod(n % p, p - 2, p));
+            for (size_t i = 0; i < n; ++i)
+                fa[i] = m.from(m.mul(fa[i], n_inv));
+        }
+
+    } // end anonymous namespace
+
+    void mul_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+    {
+        const ntt_context &ctx = context();
+        size_t rn = an + bn;
+        size_t n = 1;
+        while (n < rn)
+            n <<= 1;
+        if (n > (size_t(1) << NTT_MAX_LOG))
+            throw std::length_error("NTT size exceeds supported length.");
+
+        scratch_scope scratch;
+        limb_t *res[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            res[i] = scratch.alloc(n);
+            convolve(res[i], a, an, b, bn, n, ctx.mont[i], NTT_PRIMES[i].g);
+        }
+
+        const limb_t p0 = NTT_PRIMES[0].p, p1 = NTT_PRIMES[1].p, p2 = NTT_PRIMES[2].p;
+        const montgomery &m1 = ctx.mont[1], &m2 = ctx.mont[2];
+
+        // Восстановление коэффициентов x = v0 + p0 * (v1 + p1 * v2) и перенос
+        limb_t c0 = 0, c1 = 0, c2 = 0;
+        for (size_t k = 0; k < rn; ++k)
+        {
+            limb_t v0 = res[0][k];
+            limb_t v0_1 = v0 >= p1 ? v0 - p1 : v0;
+            limb_t v0_2 = v0 >= p2 ? v0 - p2 : v0;
+            limb_t v1 = m1.mul(m1.sub(res[1][k], v0_1), ctx.inv_p0_mod_p1);
+            limb_t v1_2 = v1 >= p2 ? v1 - p2 : v1;
+            limb_t t = m2.sub(m2.sub(res[2][k], v0_2), m2.mul(v1_2, ctx.p0_mod_p2));
+            limb_t v2 = m2.mul(t, ctx.inv_p0p1_mod_p2);
+
+            dlimb_t s = static_cast<dlimb_t>(p1) * v2 + v1;
+            dlimb_t lo = static_cast<dlimb_t>(p0) * static_cast<limb_t>(s);
+            dlimb_t hi = static_cast<dlimb_t>(p0) * static_cast<limb_t>(s >> LIMB_BITS);
+            limb_t x0 = static_cast<limb_t>(lo);
+            dlimb_t mid = (lo >> LIMB_BITS) + static_cast<limb_t>(hi);
+            limb_t x1 = static_cast<limb_t>(mid);
+            limb_t x2 = static_cast<limb_t>(hi >> LIMB_BITS) + static_cast<limb_t>(mid >> LIMB_BITS);
+
+            dlimb_t acc = static_cast<dlimb_t>(c0) + x0 + v0;
+            r[k] = static_cast<limb_t>(acc);
+            acc = (acc >> LIMB_BITS) + c1 + x1;
+            c0 = static_cast<limb_t>(acc);
+            acc = (acc >> LIMB_BITS) + c2 + x2;
+            c1 = static_cast<limb_t>(acc);
+            c2 = static_cast<limb_t>(acc >> LIMB_BITS);
+        }
+    }
+
+} // namespace limbs
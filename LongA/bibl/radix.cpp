@@ -0,0 +1,159 @@
+#include "limbs.hpp"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+namespace limbs {
+
+    namespace {
+
+        // Наибольшая степень десяти, помещающаяся в слово
+        constexpr limb_t CHUNK_BASE = 10000000000000000000ULL;
+        constexpr size_t CHUNK_DIGITS = 19;
+
+        // До этого размера (в словах) перевод идёт делением на 10^19
+        constexpr size_t RADIX_BASECASE_LIMBS = 32;
+
+        void write_padded(const digit_sink &out, const std::string &digits, size_t width)
+        {
+            static const std::string zeros(64, '0');
+            for (size_t pad = digits.size(); pad < width;)
+            {
+                size_t n = std::min(width - pad, zeros.size());
+                out(zeros.data(), n);
+                pad += n;
+            }
+            out(digits.data(), digits.size());
+        }
+
+        std::string basecase_to_decimal(const limb_vector &v)
+        {
+            std::vector<limb_t> chunks;
+            limb_vector t = v;
+            while (!t.empty())
+            {
+                chunks.push_back(divrem_1(t.data(), t.data(), t.size(), CHUNK_BASE));
+                normalize(t);
+            }
+            std::string result;
+            auto append = [&result](const char *digits, size_t n) { result.append(digits, n); };
+            for (size_t i = chunks.size(); i-- > 0;)
+            {
+                std::string digits = std::to_string(chunks[i]);
+                write_padded(append, digits, i + 1 == chunks.size() ? 0 : CHUNK_DIGITS);
+            }
+            return result;
+        }
+
+        // Десятичная запись v; при width > 0 дополняется нулями слева до width цифр.
+        // Старшая половина переводится раньше младшей, поэтому цифры уходят в out по порядку
+        void convert(const limb_vector &v, size_t width, const digit_sink &out)
+        {
+            if (v.size() <= RADIX_BASECASE_LIMBS)
+            {
+                write_padded(out, basecase_to_decimal(v), width);
+                return;
+            }
+
+            // Делим на 10^(19 * 2^k), примерно вдвое меньшее по длине
+            size_t level = 0;
+            while (power_of_ten(level + 1).size() * 2 <= v.size() + 1)
+                ++level;
+            limb_vector q, r;
+            divrem(v, power_of_ten(level), q, r);
+
+            size_t low_width = CHUNK_DIGITS << level;
+            convert(q, width > low_width ? width - low_width : 0, out);
+            // Частное больше не нужно: на время перевода остатка его память освобождается
+            q = limb_vector();
+            convert(r, low_width, out);
+        }
+
+        limb_vector basecase_from_decimal(const char *digits, size_t n)
+        {
+            limb_vector result;
+            size_t pos = 0;
+            size_t len = n % CHUNK_DIGITS ? n % CHUNK_DIGITS : CHUNK_DIGITS;
+            while (pos < n)
+            {
+                limb_t chunk = 0;
+                limb_t scale = 1;
+                for (size_t i = 0; i < len; ++i)
+                {
+                    chunk = chunk * 10 + (digits[pos + i] - '0');
+                    scale *= 10;
+                }
+                limb_t carry = mul_1(result.data(), result.data(), result.size(), scale);
+                if (carry)
+                    result.push_back(carry);
+                carry = add_1(result.data(), result.data(), result.size(), chunk);
+                if (carry || (result.empty() && chunk))
+                    result.push_back(result.empty() ? chunk : carry);
+                pos += len;
+                len = CHUNK_DIGITS;
+            }
+            normalize(result);
+            return result;
+        }
+
+    } // end anonymous namespace
+
+    const limb_vector &power_of_ten(size_t level)
+    {
+        static std::mutex mutex;
+        static std::deque<limb_vector> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        while (cache.size() <= level)
+        {
+            if (cache.empty())
+                cache.push_back({CHUNK_BASE});
+            else
+                cache.push_back(mul(cache.back(), cache.back()));
+        }
+        return cache[level];
+    }
+
+    limb_vector power_of_five(size_t exponent)
+    {
+        limb_vector result{1};
+        for (int bit = LIMB_BITS - 1; bit >= 0; --bit)
+        {
+            result = mul(result, result);
+            if ((exponent >> bit) & 1)
+            {
+                limb_t carry = mul_1(result.data(), result.data(), result.size(), 5);
+                if (carry)
+                    result.push_back(carry);
+            }
+        }
+        return result;
+    }
+
+    limb_vector from_decimal(const char *digits, size_t n)
+    {
+        if (n <= RADIX_BASECASE_LIMBS * CHUNK_DIGITS)
+            return basecase_from_decimal(digits, n);
+
+        // Младшие 19 * 2^k цифр и старшая часть переводятся независимо
+        size_t level = 0;
+        while ((CHUNK_DIGITS << (level + 1)) * 2 <= n)
+            ++level;
+        size_t low_n = CHUNK_DIGITS << level;
+        limb_vector high = from_decimal(digits, n - low_n);
+        limb_vector low = from_decimal(digits + n - low_n, low_n);
+        return add(mul(high, power_of_ten(level)), low);
+    }
+
+    std::string to_decimal(const limb_vector &v, size_t width)
+    {
+        std::string out;
+        convert(v, width, [&out](const char *digits, size_t n) { out.append(digits, n); });
+        return out;
+    }
+
+    void write_decimal(const limb_vector &v, size_t width, const digit_sink &out)
+    {
+        convert(v, width, out);
+    }
+
+} // namespace limbs
@@ -1,4 +1,6 @@
 #include "head.hpp"
+#include "limbs.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <cmath>
 #include <stdexcept>
@@ -8,227 +10,114 @@
 
 namespace {
 
-    std::vector<char> trim_leading_zeros(const std::vector<char> &bit_vector_)
+    // Сравнение модулей двух чисел с учётом разной точности
+    int compare_magnitude(const LongNumber &a, const LongNumber &b)
     {
-        size_t idx = 0;
-        while (idx < bit_vector_.size() - 1 && !bit_vector_[idx])
-        {
-            idx++;
-        }
-        return std::vector<char>(bit_vector_.begin() + idx, bit_vector_.end());
-    }
-
-    std::vector<char> right_shift(const std::vector<char> &bit_vector_, int shift)
-    {
-        if (shift >= static_cast<int>(bit_vector_.size()))
-        {
-            return std::vector<char>{false};
-        }
-        return std::vector<char>(bit_vector_.begin(), bit_vector_.end() - shift);
-    }
-
-    int compare_bit_vectors(const std::vector<char> &a, const std::vector<char> &b)
-    {
-        std::vector<char> A = trim_leading_zeros(a);
-        std::vector<char> B = trim_leading_zeros(b);
-        if (A.size() < B.size())
-            return -1;
-        if (A.size() > B.size())
-            return 1;
-        for (size_t i = 0; i < A.size(); ++i)
-        {
-            if (A[i] != B[i])
-                return (A[i] ? 1 : -1);
-        }
-        return 0;
+        int precision = std::max(a.get_precision(), b.get_precision());
+        return limbs::cmp_shifted(a.get_limbs(), precision - a.get_precision(),
+                                  b.get_limbs(), precision - b.get_precision());
     }
 
-    std::vector<char> subtract_bit_vectors(const std::vector<char> &a, const std::vector<char> &b)
-    {
-        size_t n = std::max(a.size(), b.size());
-        std::vector<char> A(n, false), B(n, false);
-        int diffA = n - a.size();
-        for (size_t i = 0; i < a.size(); i++)
-        {
-            A[diffA + i] = a[i];
-        }
-        int diffB = n - b.size();
-        for (size_t i = 0; i < b.size(); i++)
-        {
-            B[diffB + i] = b[i];
-        }
-        std::vector<char> result(n, false);
-        bool borrow = false;
-        for (int i = static_cast<int>(n) - 1; i >= 0; i--)
-        {
-            int ai = A[i] ? 1 : 0;
-            int bi = B[i] ? 1 : 0;
-            int sub = ai - bi - (borrow ? 1 : 0);
-            if (sub < 0)
-            {
-                sub += 2;
-                borrow = true;
-            }
-            else
-            {
-                borrow = false;
-            }
-            result[i] = (sub != 0);
-        }
-        return trim_leading_zeros(result);
-    }
+} // end anonymous namespace
 
-    std::vector<char> divide_bit_vectors(const std::vector<char> &dividend, const std::vector<char> &divisor, int prec)
-    {
-        std::vector<char> Q;
-        std::vector<char> R;
-        for (size_t i = 0; i < dividend.size(); i++)
-        {
-            R.push_back(dividend[i]);
-            R = trim_leading_zeros(R);
-            if (compare_bit_vectors(R, divisor) >= 0)
-            {
-                R = subtract_bit_vectors(R, divisor);
-                Q.push_back(true);
-            }
-            else
-            {
-                Q.push_back(false);
-            }
-        }
-        while (Q.size() > prec + 1 && Q[0] == 0)
-            Q.erase(Q.begin());
-        if (Q.empty())
-            Q.push_back(false);
-        return Q;
-    }
+LongNumber LongNumber::from_limbs(limbs::limb_vector limbs, int precision, bool is_negative)
+{
+    LongNumber res;
+    limbs::normalize(limbs);
+    res.limbs_ = std::move(limbs);
+    res.precision_ = precision;
+    res.is_negative_ = is_negative && !res.limbs_.empty();
+    return res;
+}
 
-    std::vector<char> multiply_bit_vectors(const std::vector<char> &a, const std::vector<char> &b)
+LongNumber::LongNumber(long double number, int precision_, bool is_negative)
+    : precision_(precision_), is_negative_(false)
+{
+    // Те же биты, что даёт convert_to_binary, но сразу в слова, без промежуточного вектора
+    long double abs_number = std::abs(number);
+    long double integer_part = std::floor(abs_number);
+    long double fractional_part = abs_number - integer_part;
+    add_word(static_cast<std::uint64_t>(static_cast<long long>(integer_part)), false);
+    for (int i = precision_ - 1; i >= 0 && fractional_part > 0; --i)
     {
-        size_t n = a.size();
-        size_t m = b.size();
-        std::vector<char> result(n + m, false);
-        for (int i = static_cast<int>(m) - 1; i >= 0; i--)
+        fractional_part *= 2;
+        if (fractional_part >= 1)
         {
-            if (b[i])
-            {
-                int shift = m - 1 - i;
-                std::vector<char> shifted(a.size() + shift, false);
-                for (size_t j = 0; j < a.size(); j++)
-                {
-                    shifted[j] = a[j];
-                }
-                int offset = result.size() - shifted.size();
-                bool carry = false;
-                for (int k = static_cast<int>(shifted.size()) - 1; k >= 0; k--)
-                {
-                    int sum = (result[offset + k] ? 1 : 0) + (shifted[k] ? 1 : 0) + (carry ? 1 : 0);
-                    result[offset + k] = (sum % 2) != 0;
-                    carry = (sum / 2) != 0;
-                }
-                int k = offset - 1;
-                while (carry && k >= 0)
-                {
-                    int sum = (result[k] ? 1 : 0) + 1;
-                    result[k] = (sum % 2) != 0;
-                    carry = (sum / 2) != 0;
-                    k--;
-                }
-            }
+            limbs::set_bit(limbs_, i);
+            fractional_part -= 1;
         }
-        return trim_leading_zeros(result);
     }
-
-} // end anonymous namespace
-
-LongNumber::LongNumber(long double number, int precision_, bool is_negative)
-    : precision_(precision_), is_negative_(is_negative)
-{
-    bit_vector_ = convert_to_binary(number, precision_, is_negative);
+    is_negative_ = is_negative && !limbs_.empty();
 }
 
 LongNumber::LongNumber(const std::string &str, int precision_)
     : precision_(precision_)
 {
+    LONGNUM_STATS_OP(from_string, str.size() / 19);
     size_t start = 0;
-    if (str[start] == '-')
+    bool negative = false;
+    if (!str.empty() && str[start] == '-')
     {
-        is_negative_ = true;
+        negative = true;
         start++;
     }
-    else
-    {
-        is_negative_ = false;
-    }
     size_t dot_pos = str.find('.');
-    std::string integer_part = str.substr(start, dot_pos - start);
-    std::string fractional_part = (dot_pos != std::string::npos) ? str.substr(dot_pos + 1) : "";
-
-    std::vector<char> integer_binary;
-    if (!integer_part.empty())
-    {
-        std::string temp = integer_part;
-        while (temp != "0")
-        {
-            int remainder = 0;
-            std::string next_temp;
-            for (char ch : temp)
-            {
-                int digit = ch - '0';
-                int value = remainder * 10 + digit;
-                next_temp.push_back((value / 2) + '0');
-                remainder = value % 2;
-            }
-            integer_binary.push_back(remainder);
-            temp = next_temp;
-            temp.erase(0, temp.find_first_not_of('0'));
-            if (temp.empty())
-                temp = "0";
-        }
-        std::reverse(integer_binary.begin(), integer_binary.end());
-    }
-    else
+    size_t int_end = dot_pos != std::string::npos ? dot_pos : str.size();
+    size_t frac_start = dot_pos != std::string::npos ? dot_pos + 1 : str.size();
+    for (size_t i = start; i < str.size(); ++i)
     {
-        integer_binary.push_back(false);
+        if (i != dot_pos && (str[i] < '0' || str[i] > '9'))
+            throw std::invalid_argument("invalid digit in number string.");
     }
 
-    std::vector<char> fractional_binary;
-    if (!fractional_part.empty())
-    {
-        long double frac = std::stold("0." + fractional_part);
-        for (int i = 0; i < precision_; ++i)
-        {
-            frac *= 2;
-            bool bit = (frac >= 1.0);
-            fractional_binary.push_back(bit);
-            if (bit)
-            {
-                frac -= 1.0;
-            }
-        }
-    }
-    else
+    // Целая часть: перевод группами по 19 цифр со сдвигом на precision_ бит
+    limbs_ = limbs::shl(limbs::from_decimal(str.data() + start, int_end - start), precision_);
+
+    // Дробная часть f из L цифр: floor(f * 2^p / 10^L) = floor(f * 2^(p - L) / 5^L)
+    size_t digits = str.size() - frac_start;
+    if (digits > 0)
     {
-        for (int i = 0; i < precision_; ++i)
-        {
-            fractional_binary.push_back(false);
-        }
+        limbs::limb_vector frac = limbs::from_decimal(str.data() + frac_start, digits);
+        size_t bits = static_cast<size_t>(precision_);
+        frac = bits >= digits ? limbs::shl(frac, bits - digits) : limbs::shr(frac, digits - bits);
+        limbs::limb_vector q, r;
+        limbs::divrem(frac, limbs::power_of_five(digits), q, r);
+        limbs_ = limbs::add(limbs_, q);
     }
 
-    bit_vector_ = integer_binary;
-    bit_vector_.insert(bit_vector_.end(), fractional_binary.begin(), fractional_binary.end());
+    is_negative_ = negative && !limbs_.empty();
 }
 
 LongNumber::LongNumber(const LongNumber &other)
-    : bit_vector_(other.bit_vector_), precision_(other.precision_), is_negative_(other.is_negative_) {}
+    : limbs_(other.limbs_), precision_(other.precision_), is_negative_(other.is_negative_) {}
+
+LongNumber::LongNumber(LongNumber &&other) noexcept
+    : limbs_(std::move(other.limbs_)), precision_(other.precision_), is_negative_(other.is_negative_)
+{
+    other.limbs_.clear();
+    other.is_negative_ = false;
+}
 
 LongNumber &LongNumber::operator=(const LongNumber &other)
 {
     if (this != &other)
     {
-        bit_vector_ = other.bit_vector_;
+        limbs_ = other.limbs_;
+        precision_ = other.precision_;
+        is_negative_ = other.is_negative_;
+    }
+    return *this;
+}
+
+LongNumber &LongNumber::operator=(LongNumber &&other) noexcept
+{
+    if (this != &other)
+    {
+        limbs_ = std::move(other.limbs_);
         precision_ = other.precision_;
         is_negative_ = other.is_negative_;
+        other.limbs_.clear();
+        other.is_negative_ = false;
     }
     return *this;
 }
@@ -259,216 +148,371 @@ std::vector<char> LongNumber::convert_to_binary(long double number, int precisio
     return binary;
 }
 
-static void align_bit_vectors(const LongNumber &num1, const LongNumber &num2,
-                              std::vector<char> &aligned_bits1, std::vector<char> &aligned_bits2,
-                              int &aligned_int_length, int &aligned_frac_length)
+std::vector<char> LongNumber::get_bit_vector() const
 {
-    int num1_int_length = num1.get_bit_vector().size() - num1.get_precision();
-    int num2_int_length = num2.get_bit_vector().size() - num2.get_precision();
-    aligned_int_length = std::max(num1_int_length, num2_int_length);
-    aligned_frac_length = std::max(num1.get_precision(), num2.get_precision());
+    size_t total = std::max(limbs::bit_length(limbs_), static_cast<size_t>(precision_) + 1);
+    std::vector<char> bits(total, false);
+    for (size_t i = 0; i < total; ++i)
+    {
+        bits[total - 1 - i] = limbs::test_bit(limbs_, i);
+    }
+    return bits;
+}
 
+LongNumber LongNumber::operator+(const LongNumber &other) const &
+{
+    LONGNUM_STATS_OP(add, std::max(limbs_.size(), other.limbs_.size()));
+    int new_frac_len = std::max(precision_, other.precision_);
+    const limbs::limb_vector *a = &limbs_;
+    const limbs::limb_vector *b = &other.limbs_;
+    limbs::limb_vector aligned;
+    if (precision_ < new_frac_len)
+    {
+        aligned = limbs::shl(limbs_, new_frac_len - precision_);
+        a = &aligned;
+    }
+    else if (other.precision_ < new_frac_len)
     {
-        int num1_leading_zeros = aligned_int_length - num1_int_length;
-        for (int i = 0; i < num1_leading_zeros; i++)
-            aligned_bits1.push_back(false);
-        const auto &num1_bits = num1.get_bit_vector();
-        aligned_bits1.insert(aligned_bits1.end(), num1_bits.begin(), num1_bits.end());
-        int num1_trailing_zeros = aligned_frac_length - num1.get_precision();
-        for (int i = 0; i < num1_trailing_zeros; i++)
-            aligned_bits1.push_back(false);
+        aligned = limbs::shl(other.limbs_, new_frac_len - other.precision_);
+        b = &aligned;
     }
 
+    if (is_negative_ == other.is_negative_)
+    {
+        return from_limbs(limbs::add(*a, *b), new_frac_len, is_negative_);
+    }
+    int cmp = limbs::cmp(*a, *b);
+    if (cmp == 0)
+    {
+        return from_limbs({}, new_frac_len, false);
+    }
+    if (cmp > 0)
     {
-        int num2_leading_zeros = aligned_int_length - num2_int_length;
-        for (int i = 0; i < num2_leading_zeros; i++)
-            aligned_bits2.push_back(false);
-        const auto &num2_bits = num2.get_bit_vector();
-        aligned_bits2.insert(aligned_bits2.end(), num2_bits.begin(), num2_bits.end());
-        int num2_trailing_zeros = aligned_frac_length - num2.get_precision();
-        for (int i = 0; i < num2_trailing_zeros; i++)
-            aligned_bits2.push_back(false);
+        return from_limbs(limbs::sub(*a, *b), new_frac_len, is_negative_);
     }
+    return from_limbs(limbs::sub(*b, *a), new_frac_len, other.is_negative_);
 }
 
-LongNumber LongNumber::operator+(const LongNumber &other) const
+LongNumber LongNumber::operator-() const &
 {
-    std::vector<char> a, b;
-    int new_int_len, new_frac_len;
-    align_bit_vectors(*this, other, a, b, new_int_len, new_frac_len);
-    if (is_negative_ == other.is_negative_)
+    LongNumber res(*this);
+    res.is_negative_ = !is_negative_ && !limbs_.empty();
+    return res;
+}
+
+LongNumber LongNumber::operator-(const LongNumber &other) const &
+{
+    LongNumber res(*this);
+    res.add_signed(other, true);
+    return res;
+}
+
+LongNumber LongNumber::operator>>(int shift) const &
+{
+    if (shift < 0)
     {
-        int n = a.size();
-        int carry = 0;
-        std::vector<char> sum(n, false);
-        for (int i = n - 1; i >= 0; i--)
-        {
-            int bit_a = a[i] ? 1 : 0;
-            int bit_b = b[i] ? 1 : 0;
-            int s = bit_a + bit_b + carry;
-            sum[i] = (s % 2 != 0);
-            carry = s / 2;
-        }
-        if (carry)
-        {
-            sum.insert(sum.begin(), true);
-            new_int_len++;
-        }
-        LongNumber res(0, new_frac_len, is_negative_);
-        res.bit_vector_ = sum;
-        return res;
+        throw std::invalid_argument("shift cannot be negative.");
     }
-    else
+    LONGNUM_STATS_OP(shift, limbs_.size());
+    return from_limbs(limbs::shr(limbs_, shift), precision_, is_negative_);
+}
+
+LongNumber LongNumber::operator+(const LongNumber &other) &&
+{
+    add_signed(other, false);
+    return std::move(*this);
+}
+
+LongNumber LongNumber::operator-() &&
+{
+    is_negative_ = !is_negative_ && !limbs_.empty();
+    return std::move(*this);
+}
+
+LongNumber LongNumber::operator-(const LongNumber &other) &&
+{
+    add_signed(other, true);
+    return std::move(*this);
+}
+
+LongNumber LongNumber::operator>>(int shift) &&
+{
+    *this >>= shift;
+    return std::move(*this);
+}
+
+LongNumber &LongNumber::operator+=(const LongNumber &other)
+{
+    add_signed(other, false);
+    return *this;
+}
+
+LongNumber &LongNumber::operator-=(const LongNumber &other)
+{
+    add_signed(other, true);
+    return *this;
+}
+
+LongNumber &LongNumber::operator*=(const LongNumber &other)
+{
+    *this = *this * other;
+    return *this;
+}
+
+LongNumber &LongNumber::operator/=(const LongNumber &other)
+{
+    *this = *this / other;
+    return *this;
+}
+
+LongNumber &LongNumber::operator>>=(int shift)
+{
+    if (shift < 0)
     {
-        bool equal = true;
-        bool a_is_larger = false;
-        for (size_t i = 0; i < a.size(); i++)
-        {
-            if (a[i] != b[i])
-            {
-                equal = false;
-                a_is_larger = a[i];
-                break;
-            }
-        }
-        if (equal)
-        {
-            std::vector<char> zero(a.size(), false);
-            LongNumber res(0, new_frac_len, false);
-            res.bit_vector_ = zero;
-            return res;
-        }
-        const std::vector<char> &larger = a_is_larger ? a : b;
-        const std::vector<char> &smaller = a_is_larger ? b : a;
-        int n = larger.size();
-        int borrow = 0;
-        std::vector<char> diff(n, false);
-        for (int i = n - 1; i >= 0; i--)
-        {
-            int bit_l = larger[i] ? 1 : 0;
-            int bit_s = smaller[i] ? 1 : 0;
-            int d = bit_l - bit_s - borrow;
-            if (d < 0)
-            {
-                d += 2;
-                borrow = 1;
-            }
-            else
-            {
-                borrow = 0;
-            }
-            diff[i] = (d != 0);
-        }
-        bool res_sign = a_is_larger ? is_negative_ : other.is_negative_;
-        LongNumber res(0, new_frac_len, res_sign);
-        res.bit_vector_ = diff;
-        return res;
+        throw std::invalid_argument("shift cannot be negative.");
+    }
+    LONGNUM_STATS_OP(shift, limbs_.size());
+    size_t words = static_cast<size_t>(shift) / limbs::LIMB_BITS;
+    if (words >= limbs_.size())
+    {
+        limbs_.clear();
+        is_negative_ = false;
+        return *this;
     }
+    limbs::rshift(limbs_.data(), limbs_.data() + words, limbs_.size() - words, shift % limbs::LIMB_BITS);
+    limbs_.resize(limbs_.size() - words);
+    limbs::normalize(limbs_);
+    is_negative_ = is_negative_ && !limbs_.empty();
+    return *this;
 }
 
-LongNumber LongNumber::operator-(const LongNumber &other) const
+void LongNumber::add_signed(const LongNumber &other, bool negate)
 {
-    LongNumber temp = other;
-    temp.is_negative_ = !temp.is_negative_;
-    return *this + temp;
+    if (this == &other)
+    {
+        LongNumber copy(other);
+        add_signed(copy, negate);
+        return;
+    }
+    LONGNUM_STATS_OP(add, std::max(limbs_.size(), other.limbs_.size()));
+    if (precision_ < other.precision_)
+    {
+        limbs_ = limbs::shl(limbs_, other.precision_ - precision_);
+        precision_ = other.precision_;
+    }
+    const limbs::limb_vector *b = &other.limbs_;
+    limbs::limb_vector aligned;
+    if (other.precision_ < precision_)
+    {
+        aligned = limbs::shl(other.limbs_, precision_ - other.precision_);
+        b = &aligned;
+    }
+    add_magnitude(b->data(), b->size(), other.is_negative_ != negate);
 }
 
-LongNumber LongNumber::operator>>(int shift) const
+void LongNumber::add_magnitude(const std::uint64_t *b, size_t bn, bool negative)
 {
-    LongNumber ans(*this);
-    ans.bit_vector_.insert(ans.bit_vector_.begin(), shift, 0);
-    ans.bit_vector_.erase(ans.bit_vector_.end() - shift, ans.bit_vector_.end());
-    while (ans.bit_vector_[0] == '0' && ans.bit_vector_.size() > ans.precision_ + 1)
+    if (bn == 0)
+        return;
+
+    if (limbs_.empty() || negative == is_negative_)
+    {
+        if (limbs_.size() < bn)
+            limbs_.resize(bn, 0);
+        if (limbs::add(limbs_.data(), limbs_.data(), limbs_.size(), b, bn))
+            limbs_.push_back(1);
+        is_negative_ = negative;
+        return;
+    }
+
+    int cmp = limbs_.size() != bn ? (limbs_.size() < bn ? -1 : 1) : limbs::cmp_n(limbs_.data(), b, bn);
+    if (cmp >= 0)
+    {
+        limbs::sub(limbs_.data(), limbs_.data(), limbs_.size(), b, bn);
+        limbs::normalize(limbs_);
+        is_negative_ = is_negative_ && !limbs_.empty();
+    }
+    else
     {
-        ans.bit_vector_.erase(ans.bit_vector_.begin());
+        // |b| > |this|: вычитаем из b в памяти this
+        size_t n = limbs_.size();
+        limbs_.resize(bn, 0);
+        limbs::sub(limbs_.data(), b, bn, limbs_.data(), n);
+        limbs::normalize(limbs_);
+        is_negative_ = negative;
     }
-    return ans;
 }
 
-LongNumber LongNumber::operator*(const LongNumber &other) const
+LongNumber LongNumber::sqrt() const
 {
-    std::vector<char> a, b;
-    int new_int_len, new_frac_len;
-    align_bit_vectors(*this, other, a, b, new_int_len, new_frac_len);
-    int total_len = a.size();
-
-    std::vector<int> a_le(total_len), b_le(total_len);
-    for (int i = 0; i < total_len; i++)
+    if (is_negative_)
     {
-        a_le[i] = a[total_len - 1 - i] ? 1 : 0;
-        b_le[i] = b[total_len - 1 - i] ? 1 : 0;
+        throw std::invalid_argument("square root of a negative number.");
     }
+    LONGNUM_STATS_OP(sqrt, limbs_.size());
+    return from_limbs(limbs::isqrt(limbs::shl(limbs_, precision_)), precision_, false);
+}
+
+LongNumber LongNumber::sqr() const
+{
+    LONGNUM_STATS_OP(sqr, limbs_.size());
+    return from_limbs(limbs::mul_shr(limbs_, limbs_, precision_), precision_, false);
+}
 
-    int prod_size = total_len + total_len;
-    std::vector<int> prod(prod_size, 0);
-    for (int i = 0; i < total_len; i++)
+LongNumber LongNumber::operator*(const LongNumber &other) const &
+{
+    if (&other == this)
     {
-        for (int j = 0; j < total_len; j++)
-        {
-            prod[i + j] += a_le[i] * b_le[j];
-        }
+        return sqr();
     }
+    LONGNUM_STATS_OP(mul, std::max(limbs_.size(), other.limbs_.size()));
+    int new_frac_len = std::max(precision_, other.precision_);
+    int extra = precision_ + other.precision_ - new_frac_len;
+    // Младшие extra бит произведения отбрасываются, поэтому считаются только старшие
+    return from_limbs(limbs::mul_shr(limbs_, other.limbs_, extra), new_frac_len, is_negative_ != other.is_negative_);
+}
 
-    for (int i = 0; i < prod_size; i++)
+LongNumber LongNumber::operator/(const LongNumber &other) const &
+{
+    if (other.limbs_.empty())
     {
-        if (prod[i] >= 2)
-        {
-            int carry = prod[i] / 2;
-            prod[i] %= 2;
-            if (i + 1 < prod_size)
-                prod[i + 1] += carry;
-            else
-            {
-                prod.push_back(carry);
-                prod_size++;
-            }
-        }
+        throw std::runtime_error("Division by zero.");
     }
+    LONGNUM_STATS_OP(div, std::max(limbs_.size(), other.limbs_.size()));
+    limbs::limb_vector dividend = limbs::shl(limbs_, other.precision_);
+    limbs::limb_vector q, r;
+    limbs::divrem(dividend, other.limbs_, q, r);
+    return from_limbs(std::move(q), precision_, is_negative_ != other.is_negative_);
+}
+
+namespace {
 
-    if (prod_size <= new_frac_len)
+    std::uint64_t word_magnitude(std::int64_t value)
     {
-        std::vector<char> zero(1, false);
-        LongNumber res(0, new_frac_len, false);
-        res.bit_vector_ = zero;
-        return res;
+        return value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
     }
-    std::vector<int> shifted(prod.begin() + new_frac_len, prod.end());
-    int res_size = shifted.size();
-    std::vector<char> result(res_size, false);
-    for (int i = 0; i < res_size; i++)
+
+} // end anonymous namespace
+
+LongNumber LongNumber::operator*(std::int64_t value) const &
+{
+    LONGNUM_STATS_OP(mul_word, limbs_.size());
+    limbs::limb_vector prod(limbs_.size() + 1);
+    prod.back() = limbs::mul_1(prod.data(), limbs_.data(), limbs_.size(), word_magnitude(value));
+    return from_limbs(std::move(prod), precision_, is_negative_ != (value < 0));
+}
+
+LongNumber::expr<1> LongNumber::operator/(std::int64_t value) const &
+{
+    if (value == 0)
     {
-        result[i] = (shifted[res_size - 1 - i] != 0);
+        throw std::runtime_error("Division by zero.");
     }
+    return expr<1>{{{this, word_magnitude(value), value < 0}}};
+}
 
-    bool res_sign = (is_negative_ != other.is_negative_);
-    LongNumber res(0, new_frac_len, res_sign);
-    res.bit_vector_ = result;
-    return res;
+LongNumber &LongNumber::operator+=(std::int64_t value)
+{
+    LONGNUM_STATS_OP(add, limbs_.size());
+    add_word(word_magnitude(value), value < 0);
+    return *this;
+}
+
+LongNumber &LongNumber::operator-=(std::int64_t value)
+{
+    LONGNUM_STATS_OP(add, limbs_.size());
+    add_word(word_magnitude(value), value > 0);
+    return *this;
+}
+
+LongNumber &LongNumber::operator*=(std::int64_t value)
+{
+    LONGNUM_STATS_OP(mul_word, limbs_.size());
+    std::uint64_t carry = limbs::mul_1(limbs_.data(), limbs_.data(), limbs_.size(), word_magnitude(value));
+    if (carry)
+        limbs_.push_back(carry);
+    limbs::normalize(limbs_);
+    is_negative_ = (is_negative_ != (value < 0)) && !limbs_.empty();
+    return *this;
 }
 
-LongNumber LongNumber::operator/(const LongNumber &other) const
+LongNumber &LongNumber::operator/=(std::int64_t value)
 {
-    if (other.bit_vector_.empty() || (other.bit_vector_.size() == 1 && !other.bit_vector_[0]))
+    if (value == 0)
     {
         throw std::runtime_error("Division by zero.");
     }
-    int prec = precision_;
-    std::vector<char> dividend = bit_vector_;
-    for (int i = 0; i < prec; i++)
+    LONGNUM_STATS_OP(div_word, limbs_.size());
+    limbs::divrem_1(limbs_.data(), limbs_.data(), limbs_.size(), word_magnitude(value));
+    limbs::normalize(limbs_);
+    is_negative_ = (is_negative_ != (value < 0)) && !limbs_.empty();
+    return *this;
+}
+
+LongNumber LongNumber::operator*(std::int64_t value) &&
+{
+    *this *= value;
+    return std::move(*this);
+}
+
+LongNumber LongNumber::operator/(std::int64_t value) &&
+{
+    *this /= value;
+    return std::move(*this);
+}
+
+void LongNumber::add_word(std::uint64_t magnitude, bool negative)
+{
+    if (magnitude == 0)
+        return;
+    size_t w = precision_ / limbs::LIMB_BITS;
+    unsigned s = precision_ % limbs::LIMB_BITS;
+    std::uint64_t word[2] = {magnitude << s, s ? magnitude >> (limbs::LIMB_BITS - s) : 0};
+    size_t wn = word[1] ? 2 : 1;
+
+    if (limbs_.empty() || negative == is_negative_)
+    {
+        if (limbs_.size() < w + wn)
+            limbs_.resize(w + wn, 0);
+        if (limbs::add(limbs_.data() + w, limbs_.data() + w, limbs_.size() - w, word, wn))
+            limbs_.push_back(1);
+        is_negative_ = negative;
+        return;
+    }
+
+    int cmp = limbs::cmp_shifted(limbs_, 0, {magnitude}, precision_);
+    if (cmp == 0)
+    {
+        limbs_.clear();
+        is_negative_ = false;
+    }
+    else if (cmp > 0)
     {
-        dividend.push_back(false);
+        limbs::sub(limbs_.data() + w, limbs_.data() + w, limbs_.size() - w, word, wn);
+        limbs::normalize(limbs_);
+    }
+    else
+    {
+        limbs::limb_vector value(w + wn, 0);
+        std::copy(word, word + wn, value.begin() + w);
+        limbs_ = limbs::sub(value, limbs_);
+        is_negative_ = negative;
     }
-    std::vector<char> q = divide_bit_vectors(dividend, other.bit_vector_, prec);
-    LongNumber result(0.0, prec, is_negative_ != other.is_negative_);
-    result.bit_vector_ = q;
-    return result;
 }
 
 bool LongNumber::operator==(const LongNumber &other) const
 {
-    return bit_vector_ == other.bit_vector_ &&
-           precision_ == other.precision_ &&
-           is_negative_ == other.is_negative_;
+    LONGNUM_STATS_OP(compare, std::max(limbs_.size(), other.limbs_.size()));
+    if (is_negative_ != other.is_negative_)
+    {
+        return false;
+    }
+    // При разной точности сравниваются значения, как в operator<
+    if (precision_ != other.precision_)
+    {
+        return compare_magnitude(*this, other) == 0;
+    }
+    return limbs_ == other.limbs_;
 }
 
 bool LongNumber::operator!=(const LongNumber &other) const
@@ -478,22 +522,13 @@ bool LongNumber::operator!=(const LongNumber &other) const
 
 bool LongNumber::operator<(const LongNumber &other) const
 {
+    LONGNUM_STATS_OP(compare, std::max(limbs_.size(), other.limbs_.size()));
     if (is_negative_ != other.is_negative_)
     {
         return is_negative_;
     }
-    if (bit_vector_.size() != other.bit_vector_.size())
-    {
-        return bit_vector_.size() < other.bit_vector_.size();
-    }
-    for (size_t i = 0; i < bit_vector_.size(); ++i)
-    {
-        if (bit_vector_[i] != other.bit_vector_[i])
-        {
-            return bit_vector_[i] < other.bit_vector_[i];
-        }
-    }
-    return false;
+    int cmp = compare_magnitude(*this, other);
+    return is_negative_ ? cmp > 0 : cmp < 0;
 }
 
 bool LongNumber::operator>(const LongNumber &other) const
@@ -520,16 +555,13 @@ void LongNumber::new_precision(int new_precision)
     int old_precision = precision_;
     if (new_precision > old_precision)
     {
-        int shift = new_precision - old_precision;
-        for (int i = 0; i < shift; i++)
-        {
-            bit_vector_.push_back(false);
-        }
+        limbs_ = limbs::shl(limbs_, new_precision - old_precision);
     }
     else if (new_precision < old_precision)
     {
-        int shift = old_precision - new_precision;
-        bit_vector_ = right_shift(bit_vector_, shift);
+        limbs_ = limbs::shr(limbs_, old_precision - new_precision);
+        if (limbs_.empty())
+            is_negative_ = false;
     }
     precision_ = new_precision;
 }
@@ -537,34 +569,24 @@ void LongNumber::new_precision(int new_precision)
 LongNumber LongNumber::calculate_pi(int precision_)
 {
     LongNumber pi(0.0, precision_, false);
-    LongNumber n0(1.0, precision_, false);
-    LongNumber n(16.0, precision_, false);
 
     LongNumber a0(4.0, precision_, false);
     LongNumber b0(2.0, precision_, false);
     LongNumber c0(1.0, precision_, false);
     LongNumber d0(1.0, precision_, false);
 
-    LongNumber a(1.0, precision_, false);
-    LongNumber b(4.0, precision_, false);
-    LongNumber c(5.0, precision_, false);
-    LongNumber d(6.0, precision_, false);
-
-    LongNumber eight(8.0, precision_, false);
-
     if (precision_ == 0)
     {
-        pi = pi + LongNumber(3.0, precision_, false);
+        pi += 3;
     }
 
-    for (int k = 0; k < precision_; ++k)
+    // Член ряда вычисляется одним проходом и сразу прибавляется к сумме. Множитель 16^-k —
+    // ленивый сдвиг на 4k бит: слова частных ниже него не считаются; при 4k > precision_
+    // член обращается в ноль
+    for (int k = 0; k < precision_ && 4 * k <= precision_; ++k)
     {
-        pi = pi + n0 * (a0 / a - b0 / b - c0 / c - d0 / d);
-        n0 = n0 / n;
-        a = a + eight;
-        b = b + eight;
-        c = c + eight;
-        d = d + eight;
+        std::int64_t m = 8LL * k;
+        pi += (a0 / (m + 1) - b0 / (m + 4) - c0 / (m + 5) - d0 / (m + 6)) >> (4 * k);
     }
 
     return pi;
@@ -597,128 +619,45 @@ void LongNumber::printk_binary(const std::vector<char> &bit_vector_, int precisi
     std::cout << std::endl;
 }
 
-std::string LongNumber::MultStringOnTwo(const std::string &s) const
-{
-    std::string result = "";
-    int carry = 0;
-    for (int i = (int)s.size() - 1; i >= 0; --i)
-    {
-        int digit = s[i] - '0';
-        int value = digit * 2 + carry;
-        carry = value / 10;
-        result.push_back(char(value % 10 + '0'));
-    }
-
-    result.push_back(char('0' + carry));
-
-    std::reverse(result.begin(), result.end());
-    return result;
-}
-
-std::string LongNumber::DivStringOnTwo(const std::string &s) const
-{
-    std::string result = "";
-    int carry = 0;
-    for (char c : s)
-    {
-        int digit = c - '0';
-        int value = carry * 10 + digit;
-        carry = value % 2;
-        result.push_back(char('0' + value / 2));
-    }
-    while (carry != 0)
-    {
-        carry *= 10;
-        result.push_back(char('0' + carry / 2));
-        carry %= 2;
-    }
-    return result;
-}
-
-std::string LongNumber::SumTwoString(const std::string &num1, const std::string &num2, int type) const
+std::string LongNumber::to_string() const
 {
-    int len = std::max(num1.size(), num2.size());
-    std::string a(num1), b(num2);
-    if (type == 0)
-    {
-        a.insert(a.begin(), len - num1.size(), '0');
-        b.insert(b.begin(), len - num2.size(), '0');
-    }
-    else
-    {
-        a.insert(a.end(), len - num1.size(), '0');
-        b.insert(b.end(), len - num2.size(), '0');
-    }
-    std::string result = "";
-    int carry = 0;
-    for (int i = len - 1; i >= 0; --i)
-    {
-        int digit1 = (i < a.size() ? a[i] : '0') - '0';
-        int digit2 = (i < b.size() ? b[i] : '0') - '0';
-        int value = digit1 + digit2 + carry;
-        carry = value / 10;
-        value %= 10;
-        result.push_back(char('0' + value));
-    }
-    if (type == 0)
-        result.push_back(char('0' + carry));
-    std::reverse(result.begin(), result.end());
+    std::string result;
+    write_decimal([&result](const char *digits, size_t n) { result.append(digits, n); });
     return result;
 }
 
-std::string LongNumber::to_string() const
+void LongNumber::write_decimal(const std::function<void(const char *, size_t)> &out) const
 {
-    std::string IntegerPart = "", FractionalPart = "";
-    std::string temp = "1";
+    // Один счётчик на все пути вывода: to_string и operator<< идут через эту функцию
+    // (время включает работу out)
+    LONGNUM_STATS_OP(to_string, limbs_.size());
+    if (is_negative_)
+        out("-", 1);
 
-    for (int i = (int)bit_vector_.size() - precision_ - 1; i >= 0; --i)
     {
-        if (bit_vector_[i])
-            IntegerPart = SumTwoString(IntegerPart, temp, 0);
-        
-        temp = MultStringOnTwo(temp);
-
-        while (temp[0] == '0')
-            temp.erase(temp.begin());
-
-        while (IntegerPart[0] == '0')
-            IntegerPart.erase(IntegerPart.begin());
+        limbs::limb_vector integer = limbs::shr(limbs_, precision_);
+        if (integer.empty())
+            out("0", 1);
+        else
+            limbs::write_decimal(integer, 0, out);
     }
+    out(".", 1);
 
-    temp = "5";
-    for (int i = (int)bit_vector_.size() - precision_; i < (int)bit_vector_.size(); ++i)
+    // Дробная часть F / 2^k записывается точно как F * 5^k / 10^k
+    limbs::limb_vector fraction = limbs::low_bits(limbs_, precision_);
+    if (fraction.empty())
     {
-        if (bit_vector_[i])
-            FractionalPart = SumTwoString(FractionalPart, temp, 1);
-
-        temp = DivStringOnTwo(temp);
-
-        while (temp.back() == '0')
-            temp.pop_back();
-
-        while (FractionalPart.back() == '0')
-            FractionalPart.pop_back();
+        out("0", 1);
+        return;
     }
-
-    while (IntegerPart[0] == '0')
-        IntegerPart.erase(IntegerPart.begin());
-
-    while (FractionalPart.back() == '0')
-        FractionalPart.pop_back();
-
-    if (IntegerPart.empty())
-        IntegerPart = "0";
-    if (FractionalPart.empty())
-        FractionalPart = "0";
-
-    if(is_negative_ == true)
-        IntegerPart = "-" + IntegerPart;
-
-    return IntegerPart + "." + FractionalPart;
+    size_t zeros = limbs::trailing_zeros(fraction);
+    size_t k = precision_ - zeros;
+    fraction = limbs::shr(fraction, zeros);
+    limbs::write_decimal(limbs::mul(fraction, limbs::power_of_five(k)), k, out);
 }
 
 std::ostream &operator<<(std::ostream &os, const LongNumber &num)
 {
-    os << num.to_string();
+    num.write_decimal([&os](const char *digits, size_t n) { os.write(digits, static_cast<std::streamsize>(n)); });
     return os;
 }
@@ -0,0 +1,91 @@
+#include "scratch.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace limbs {
+
+    namespace {
+
+        // Минимальный размер блока арены (в словах)
+        constexpr size_t SCRATCH_MIN_BLOCK = size_t(1) << 15;
+
+        struct arena {
+            std::vector<std::unique_ptr<limb_t[]>> blocks;
+            std::vector<size_t> sizes;
+            std::vector<size_t> starts; // Суммарный размер всех предыдущих блоков
+            size_t block = 0;           // Текущий блок и позиция в нём
+            size_t offset = 0;
+
+            size_t used() const
+            {
+                return block < starts.size() ? starts[block] + offset : 0;
+            }
+        };
+
+        thread_local arena local;
+        std::atomic<size_t> peak_bytes{0};
+
+        void note_usage(size_t words)
+        {
+            size_t bytes = words * sizeof(limb_t);
+            size_t peak = peak_bytes.load(std::memory_order_relaxed);
+            while (bytes > peak && !peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+            {
+            }
+        }
+
+    } // end anonymous namespace
+
+    scratch_scope::scratch_scope() : block_(local.block), offset_(local.offset) {}
+
+    scratch_scope::~scratch_scope()
+    {
+        local.block = block_;
+        local.offset = offset_;
+    }
+
+    limb_t *scratch_scope::alloc(size_t n)
+    {
+        arena &a = local;
+        // Хвост блока, в который буфер не помещается, пропускаем
+        while (a.block < a.blocks.size() && a.offset + n > a.sizes[a.block])
+        {
+            ++a.block;
+            a.offset = 0;
+        }
+        if (a.block == a.blocks.size())
+        {
+            size_t size = std::max(n, SCRATCH_MIN_BLOCK);
+            if (!a.sizes.empty())
+                size = std::max(size, 2 * a.sizes.back());
+            a.starts.push_back(a.sizes.empty() ? 0 : a.starts.back() + a.sizes.back());
+            a.blocks.push_back(std::unique_ptr<limb_t[]>(new limb_t[size]));
+            LONGNUM_STATS_ALLOC(size * sizeof(limb_t));
+            a.sizes.push_back(size);
+        }
+        limb_t *p = a.blocks[a.block].get() + a.offset;
+        a.offset += n;
+        note_usage(a.used());
+        return p;
+    }
+
+    limb_t *scratch_scope::alloc_zero(size_t n)
+    {
+        limb_t *p = alloc(n);
+        std::fill(p, p + n, 0);
+        return p;
+    }
+
+    size_t scratch_peak_bytes()
+    {
+        return peak_bytes.load(std::memory_order_relaxed);
+    }
+
+    void scratch_reset_peak()
+    {
+        peak_bytes.store(0, std::memory_order_relaxed);
+    }
+
+} // namespace limbs
@@ -0,0 +1,37 @@
+#ifndef LONGNUM_SCRATCH_HPP
+#define LONGNUM_SCRATCH_HPP
+#pragma once
+
+#include "limbs.hpp"
+
+namespace limbs {
+
+    // Рабочая память для временных буферов ядер: стековая (bump) арена,
+    // своя у каждого потока. Всё, что выделено внутри области, возвращается
+    // при выходе из неё за O(1); блоки арены остаются у потока для повторного использования.
+    // Области вкладываются друг в друга строго по стеку вызовов.
+    class scratch_scope {
+    public:
+        scratch_scope();
+        ~scratch_scope();
+
+        scratch_scope(const scratch_scope &) = delete;
+        scratch_scope &operator=(const scratch_scope &) = delete;
+
+        // Буфер из n слов с неопределённым содержимым
+        limb_t *alloc(size_t n);
+        // Буфер из n нулевых слов
+        limb_t *alloc_zero(size_t n);
+
+    private:
+        size_t block_;
+        size_t offset_;
+    };
+
+    // Наибольший объём рабочей памяти одного потока (в байтах) с последнего сброса
+    size_t scratch_peak_bytes();
+    void scratch_reset_peak();
+
+} // namespace limbs
+
+#endif
@@ -0,0 +1,268 @@
+#include "head.hpp"
+#include "limbs.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Двоичный формат LongNumber (все поля little-endian):
+//
+//   0  char[4]  магия "LNUM"
+//   4  uint16   версия формата (FORMAT_VERSION)
+//   6  uint16   флаги: бит 0 — число отрицательное, остальные биты нулевые
+//   8  int32    precision — количество битов после запятой
+//  12  int32    exponent — двоичный порядок слов: |x| = слова * 2^exponent / 2^precision
+//  16  uint64   количество слов n
+//  24  uint64[n] слова модуля, младшие первыми
+//
+// save пишет exponent = 0; при ненулевом порядке load сдвигает слова к точности
+// precision. Заголовок кратен 8 байтам, поэтому при отображении файла слова
+// выровнены и используются на месте.
+
+namespace {
+
+    constexpr char MAGIC[4] = {'L', 'N', 'U', 'M'};
+    constexpr std::uint16_t FORMAT_VERSION = 1;
+    constexpr std::uint16_t FLAG_NEGATIVE = 1;
+    constexpr size_t HEADER_SIZE = 24;
+
+    constexpr bool host_little_endian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+    struct header {
+        std::uint16_t version;
+        std::uint16_t flags;
+        std::int32_t precision;
+        std::int32_t exponent;
+        std::uint64_t count;
+    };
+
+    void store_le(unsigned char *p, std::uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i)
+            p[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+
+    std::uint64_t load_le(const unsigned char *p, size_t bytes)
+    {
+        std::uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            value |= std::uint64_t(p[i]) << (8 * i);
+        return value;
+    }
+
+    [[noreturn]] void fail(const std::string &what, const std::string &path)
+    {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    // Закрывает дескриптор при выходе из области видимости
+    struct file_descriptor {
+        int fd;
+        ~file_descriptor()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    };
+
+    void write_all(int fd, const void *data, size_t n, const std::string &path)
+    {
+        const char *p = static_cast<const char *>(data);
+        while (n > 0)
+        {
+            ssize_t written = ::write(fd, p, n);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                fail("cannot write", path);
+            }
+            p += written;
+            n -= static_cast<size_t>(written);
+        }
+    }
+
+    void read_all(int fd, void *data, size_t n, const std::string &path)
+    {
+        char *p = static_cast<char *>(data);
+        while (n > 0)
+        {
+            ssize_t got = ::read(fd, p, n);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got < 0)
+                fail("cannot read", path);
+            if (got == 0)
+                throw std::runtime_error("truncated LongNumber file " + path);
+            p += got;
+            n -= static_cast<size_t>(got);
+        }
+    }
+
+    // Разбор и проверка заголовка; file_size — полный размер файла
+    header parse_header(const unsigned char *p, std::uint64_t file_size, const std::string &path)
+    {
+        if (file_size < HEADER_SIZE || std::memcmp(p, MAGIC, sizeof MAGIC) != 0)
+            throw std::runtime_error("not a LongNumber file: " + path);
+        header h;
+        h.version = static_cast<std::uint16_t>(load_le(p + 4, 2));
+        h.flags = static_cast<std::uint16_t>(load_le(p + 6, 2));
+        h.precision = static_cast<std::int32_t>(static_cast<std::uint32_t>(load_le(p + 8, 4)));
+        h.exponent = static_cast<std::int32_t>(static_cast<std::uint32_t>(load_le(p + 12, 4)));
+        h.count = load_le(p + 16, 8);
+        if (h.version == 0 || h.version > FORMAT_VERSION)
+            throw std::runtime_error("unsupported LongNumber file version " + std::to_string(h.version) + ": " + path);
+        if ((h.flags & ~FLAG_NEGATIVE) != 0 || h.precision < 0)
+            throw std::runtime_error("corrupt LongNumber header: " + path);
+        if (h.count != (file_size - HEADER_SIZE) / 8 || (file_size - HEADER_SIZE) % 8 != 0)
+            throw std::runtime_error("LongNumber file size does not match its header: " + path);
+        return h;
+    }
+
+    // Чтение числа из открытого файла размером file_size (с текущей позиции — начала файла)
+    limbs::limb_vector read_file(int fd, std::uint64_t file_size, const std::string &path, header &h)
+    {
+        unsigned char head[HEADER_SIZE] = {};
+        read_all(fd, head, std::min<std::uint64_t>(HEADER_SIZE, file_size), path);
+        h = parse_header(head, file_size, path);
+
+        limbs::limb_vector v(h.count);
+        read_all(fd, v.data(), h.count * sizeof(std::uint64_t), path);
+        if (!host_little_endian)
+        {
+            for (auto &limb : v)
+                limb = load_le(reinterpret_cast<const unsigned char *>(&limb), 8);
+        }
+        return v;
+    }
+
+    // Приведение слов с порядком exponent к порядку 0 (лишние младшие биты отбрасываются)
+    void apply_exponent(limbs::limb_vector &v, std::int32_t exponent)
+    {
+        if (exponent > 0)
+            v = limbs::shl(v, static_cast<size_t>(exponent));
+        else if (exponent < 0)
+            v = limbs::shr(v, static_cast<size_t>(-static_cast<std::int64_t>(exponent)));
+    }
+
+    // Отображение файла в память; снимается, когда вектор отпускает слова
+    class mapping : public limbs::external_storage {
+    public:
+        mapping(void *base, size_t size) : base_(base), size_(size) {}
+        ~mapping() override { ::munmap(base_, size_); }
+
+    private:
+        void *base_;
+        size_t size_;
+    };
+
+} // end anonymous namespace
+
+void LongNumber::save(const std::string &path) const
+{
+    unsigned char head[HEADER_SIZE];
+    std::memcpy(head, MAGIC, sizeof MAGIC);
+    store_le(head + 4, FORMAT_VERSION, 2);
+    store_le(head + 6, is_negative_ ? FLAG_NEGATIVE : 0, 2);
+    store_le(head + 8, static_cast<std::uint32_t>(precision_), 4);
+    store_le(head + 12, 0, 4);
+    store_le(head + 16, limbs_.size(), 8);
+
+    // Запись во временный файл рядом с path и переименование поверх него: path может быть
+    // отображён в память этим же числом (load_mapped), и усечение файла сделало бы его
+    // слова недоступными. Заодно при ошибке старый файл остаётся целым
+    std::string temp = path + ".XXXXXX";
+    file_descriptor file{::mkstemp(temp.data())};
+    if (file.fd < 0)
+        fail("cannot create temporary file for", path);
+    try
+    {
+        if (::fchmod(file.fd, 0644) != 0)
+            fail("cannot write", temp);
+        write_all(file.fd, head, HEADER_SIZE, temp);
+        if (host_little_endian)
+        {
+            write_all(file.fd, limbs_.data(), limbs_.size() * sizeof(std::uint64_t), temp);
+        }
+        else
+        {
+            limbs::limb_vector le(limbs_.size());
+            for (size_t i = 0; i < le.size(); ++i)
+                store_le(reinterpret_cast<unsigned char *>(&le[i]), limbs_[i], 8);
+            write_all(file.fd, le.data(), le.size() * sizeof(std::uint64_t), temp);
+        }
+        int fd = file.fd;
+        file.fd = -1;
+        if (::close(fd) != 0)
+            fail("cannot write", temp);
+        if (std::rename(temp.c_str(), path.c_str()) != 0)
+            fail("cannot replace", path);
+    }
+    catch (...)
+    {
+        ::unlink(temp.c_str());
+        throw;
+    }
+}
+
+LongNumber LongNumber::load(const std::string &path)
+{
+    file_descriptor file{::open(path.c_str(), O_RDONLY)};
+    if (file.fd < 0)
+        fail("cannot open", path);
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0)
+        fail("cannot stat", path);
+
+    header h;
+    limbs::limb_vector v = read_file(file.fd, static_cast<std::uint64_t>(st.st_size), path, h);
+    apply_exponent(v, h.exponent);
+    return from_limbs(std::move(v), h.precision, (h.flags & FLAG_NEGATIVE) != 0);
+}
+
+LongNumber LongNumber::load_mapped(const std::string &path)
+{
+    file_descriptor file{::open(path.c_str(), O_RDONLY)};
+    if (file.fd < 0)
+        fail("cannot open", path);
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0)
+        fail("cannot stat", path);
+    size_t size = static_cast<size_t>(st.st_size);
+    header h;
+
+    // Файл короче заголовка (отображение пустого файла невозможно) и порядок байтов,
+    // отличный от little-endian, — обычное чтение из того же открытого файла
+    if (size < HEADER_SIZE || !host_little_endian)
+    {
+        limbs::limb_vector v = read_file(file.fd, size, path, h);
+        apply_exponent(v, h.exponent);
+        return from_limbs(std::move(v), h.precision, (h.flags & FLAG_NEGATIVE) != 0);
+    }
+
+    // MAP_PRIVATE: запись в слова (операции на месте) копирует страницу и не меняет файл
+    void *base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file.fd, 0);
+    if (base == MAP_FAILED)
+        fail("cannot map", path);
+    // Пока слова не переданы вектору, отображение снимает owner: и при исключении
+    // parse_header, и после копирования слов при ненулевом порядке
+    std::unique_ptr<mapping> owner(new mapping(base, size));
+
+    auto *bytes = static_cast<unsigned char *>(base);
+    h = parse_header(bytes, size, path);
+    auto *words = reinterpret_cast<std::uint64_t *>(bytes + HEADER_SIZE);
+    if (h.exponent != 0)
+    {
+        limbs::limb_vector copy(words, words + h.count);
+        apply_exponent(copy, h.exponent);
+        return from_limbs(std::move(copy), h.precision, (h.flags & FLAG_NEGATIVE) != 0);
+    }
+    limbs::limb_vector v;
+    v.adopt(words, h.count, owner.release());
+    return from_limbs(std::move(v), h.precision, (h.flags & FLAG_NEGATIVE) != 0);
+}
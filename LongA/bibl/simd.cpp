@@ -0,0 +1,375 @@
+#include "limbs.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#define LONGNUM_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace limbs {
+
+    namespace {
+
+        // Переносимые ядра (без векторных инструкций); carry — входящий перенос или заём
+        limb_t add_n_carry(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                dlimb_t t = static_cast<dlimb_t>(a[i]) + b[i] + carry;
+                r[i] = static_cast<limb_t>(t);
+                carry = static_cast<limb_t>(t >> LIMB_BITS);
+            }
+            return carry;
+        }
+
+        limb_t sub_n_carry(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                dlimb_t t = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+                r[i] = static_cast<limb_t>(t);
+                borrow = static_cast<limb_t>(t >> LIMB_BITS) & 1;
+            }
+            return borrow;
+        }
+
+        limb_t add_n_generic(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            return add_n_carry(r, a, b, n, 0);
+        }
+
+        limb_t sub_n_generic(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            return sub_n_carry(r, a, b, n, 0);
+        }
+
+        int cmp_n_generic(const limb_t *a, const limb_t *b, size_t n)
+        {
+            while (n-- > 0)
+            {
+                if (a[n] != b[n])
+                    return a[n] > b[n] ? 1 : -1;
+            }
+            return 0;
+        }
+
+        size_t normalized_size_generic(const limb_t *a, size_t n)
+        {
+            while (n > 0 && a[n - 1] == 0)
+                --n;
+            return n;
+        }
+
+        // Переносы между словами блока по маскам порождения g и распространения p
+        // (бит i — слово i): слово i получает перенос, если его породило слово i - 1
+        // или перенос пришёл в слово i - 1, а оно его распространяет. Сложение
+        // ((g << 1) | c) + p продвигает перенос через серии битов p за одну операцию
+        // (перенос с упреждением); бит lanes результата — перенос из блока
+        inline unsigned lookahead(unsigned g, unsigned p, limb_t &carry, unsigned lanes)
+        {
+            unsigned x = ((g << 1) | static_cast<unsigned>(carry)) + p;
+            carry = (x >> lanes) & 1;
+            return (x ^ p) & ((1u << lanes) - 1);
+        }
+
+#ifdef LONGNUM_SIMD_X86
+
+        // SSE2: 64-битных беззнаковых сравнений нет, поэтому сложение и вычитание
+        // выполняются цепочкой adc/sbb, а сравнение и поиск нулей — по 2 слова
+        __attribute__((target("sse2"))) limb_t add_n_sse2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            unsigned char carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                unsigned long long t;
+                carry = _addcarry_u64(carry, a[i], b[i], &t);
+                r[i] = t;
+            }
+            return carry;
+        }
+
+        __attribute__((target("sse2"))) limb_t sub_n_sse2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            unsigned char borrow = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                unsigned long long t;
+                borrow = _subborrow_u64(borrow, a[i], b[i], &t);
+                r[i] = t;
+            }
+            return borrow;
+        }
+
+        __attribute__((target("sse2"))) int cmp_n_sse2(const limb_t *a, const limb_t *b, size_t n)
+        {
+            while (n >= 2)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + n - 2));
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + n - 2));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)) != 0xFFFF)
+                    return cmp_n_generic(a + n - 2, b + n - 2, 2);
+                n -= 2;
+            }
+            return cmp_n_generic(a, b, n);
+        }
+
+        __attribute__((target("sse2"))) size_t normalized_size_sse2(const limb_t *a, size_t n)
+        {
+            __m128i zero = _mm_setzero_si128();
+            while (n >= 2)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + n - 2));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, zero)) != 0xFFFF)
+                    break;
+                n -= 2;
+            }
+            return normalized_size_generic(a, n);
+        }
+
+        // AVX2: блоки по 8 слов (два регистра). Суммы слов считаются независимо,
+        // переносы между ними — по маскам через lookahead, затем прибавляются
+        // к тем словам, куда они пришли
+        __attribute__((target("avx2"))) inline __m256i lane_mask_avx2(unsigned bits)
+        {
+            const __m256i lanes = _mm256_setr_epi64x(1, 2, 4, 8);
+            __m256i m = _mm256_and_si256(_mm256_set1_epi64x(bits), lanes);
+            return _mm256_cmpeq_epi64(m, lanes);
+        }
+
+        __attribute__((target("avx2"))) inline unsigned movemask_avx2(__m256i v)
+        {
+            return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(v)));
+        }
+
+        __attribute__((target("avx2"))) limb_t add_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(limb_t(1) << (LIMB_BITS - 1)));
+            const __m256i ones = _mm256_set1_epi64x(-1);
+            limb_t carry = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 4));
+                __m256i s0 = _mm256_add_epi64(x0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+                __m256i s1 = _mm256_add_epi64(x1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 4)));
+                // Перенос порождён, если сумма меньше слагаемого (сравнение без знака через сдвиг на 2^63)
+                __m256i g0 = _mm256_cmpgt_epi64(_mm256_xor_si256(x0, sign), _mm256_xor_si256(s0, sign));
+                __m256i g1 = _mm256_cmpgt_epi64(_mm256_xor_si256(x1, sign), _mm256_xor_si256(s1, sign));
+                unsigned g = movemask_avx2(g0) | (movemask_avx2(g1) << 4);
+                unsigned p = movemask_avx2(_mm256_cmpeq_epi64(s0, ones)) | (movemask_avx2(_mm256_cmpeq_epi64(s1, ones)) << 4);
+                unsigned c = lookahead(g, p, carry, 8);
+                // Прибавление 1 — вычитание маски из -1
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_sub_epi64(s0, lane_mask_avx2(c & 15)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i + 4), _mm256_sub_epi64(s1, lane_mask_avx2(c >> 4)));
+            }
+            return add_n_carry(r + i, a + i, b + i, n - i, carry);
+        }
+
+        __attribute__((target("avx2"))) limb_t sub_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(limb_t(1) << (LIMB_BITS - 1)));
+            const __m256i zero = _mm256_setzero_si256();
+            limb_t borrow = 0;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 4));
+                __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+                __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 4));
+                __m256i d0 = _mm256_sub_epi64(x0, y0);
+                __m256i d1 = _mm256_sub_epi64(x1, y1);
+                // Заём порождён при x < y, распространяется через нулевую разность
+                __m256i g0 = _mm256_cmpgt_epi64(_mm256_xor_si256(y0, sign), _mm256_xor_si256(x0, sign));
+                __m256i g1 = _mm256_cmpgt_epi64(_mm256_xor_si256(y1, sign), _mm256_xor_si256(x1, sign));
+                unsigned g = movemask_avx2(g0) | (movemask_avx2(g1) << 4);
+                unsigned p = movemask_avx2(_mm256_cmpeq_epi64(d0, zero)) | (movemask_avx2(_mm256_cmpeq_epi64(d1, zero)) << 4);
+                unsigned c = lookahead(g, p, borrow, 8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_add_epi64(d0, lane_mask_avx2(c & 15)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i + 4), _mm256_add_epi64(d1, lane_mask_avx2(c >> 4)));
+            }
+            return sub_n_carry(r + i, a + i, b + i, n - i, borrow);
+        }
+
+        __attribute__((target("avx2"))) int cmp_n_avx2(const limb_t *a, const limb_t *b, size_t n)
+        {
+            while (n >= 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + n - 4));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + n - 4));
+                unsigned ne = ~movemask_avx2(_mm256_cmpeq_epi64(x, y)) & 15;
+                if (ne != 0)
+                {
+                    size_t k = n - 4 + (31 - __builtin_clz(ne));
+                    return a[k] > b[k] ? 1 : -1;
+                }
+                n -= 4;
+            }
+            return cmp_n_generic(a, b, n);
+        }
+
+        __attribute__((target("avx2"))) size_t normalized_size_avx2(const limb_t *a, size_t n)
+        {
+            while (n >= 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + n - 4));
+                if (!_mm256_testz_si256(x, x))
+                    break;
+                n -= 4;
+            }
+            return normalized_size_generic(a, n);
+        }
+
+        // AVX-512: то же по 16 слов, маски сравнений сразу получаются в k-регистрах
+        __attribute__((target("avx512f"))) limb_t add_n_avx512(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m512i ones = _mm512_set1_epi64(-1);
+            limb_t carry = 0;
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                __m512i x0 = _mm512_loadu_si512(a + i);
+                __m512i x1 = _mm512_loadu_si512(a + i + 8);
+                __m512i s0 = _mm512_add_epi64(x0, _mm512_loadu_si512(b + i));
+                __m512i s1 = _mm512_add_epi64(x1, _mm512_loadu_si512(b + i + 8));
+                unsigned g = _mm512_cmplt_epu64_mask(s0, x0) | (static_cast<unsigned>(_mm512_cmplt_epu64_mask(s1, x1)) << 8);
+                unsigned p = _mm512_cmpeq_epu64_mask(s0, ones) | (static_cast<unsigned>(_mm512_cmpeq_epu64_mask(s1, ones)) << 8);
+                unsigned c = lookahead(g, p, carry, 16);
+                _mm512_storeu_si512(r + i, _mm512_mask_sub_epi64(s0, static_cast<__mmask8>(c), s0, ones));
+                _mm512_storeu_si512(r + i + 8, _mm512_mask_sub_epi64(s1, static_cast<__mmask8>(c >> 8), s1, ones));
+            }
+            return add_n_carry(r + i, a + i, b + i, n - i, carry);
+        }
+
+        __attribute__((target("avx512f"))) limb_t sub_n_avx512(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+        {
+            const __m512i ones = _mm512_set1_epi64(-1);
+            const __m512i zero = _mm512_setzero_si512();
+            limb_t borrow = 0;
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                __m512i x0 = _mm512_loadu_si512(a + i);
+                __m512i x1 = _mm512_loadu_si512(a + i + 8);
+                __m512i y0 = _mm512_loadu_si512(b + i);
+                __m512i y1 = _mm512_loadu_si512(b + i + 8);
+                __m512i d0 = _mm512_sub_epi64(x0, y0);
+                __m512i d1 = _mm512_sub_epi64(x1, y1);
+                unsigned g = _mm512_cmplt_epu64_mask(x0, y0) | (static_cast<unsigned>(_mm512_cmplt_epu64_mask(x1, y1)) << 8);
+                unsigned p = _mm512_cmpeq_epu64_mask(d0, zero) | (static_cast<unsigned>(_mm512_cmpeq_epu64_mask(d1, zero)) << 8);
+                unsigned c = lookahead(g, p, borrow, 16);
+                _mm512_storeu_si512(r + i, _mm512_mask_add_epi64(d0, static_cast<__mmask8>(c), d0, ones));
+                _mm512_storeu_si512(r + i + 8, _mm512_mask_add_epi64(d1, static_cast<__mmask8>(c >> 8), d1, ones));
+            }
+            return sub_n_carry(r + i, a + i, b + i, n - i, borrow);
+        }
+
+        __attribute__((target("avx512f"))) int cmp_n_avx512(const limb_t *a, const limb_t *b, size_t n)
+        {
+            while (n >= 8)
+            {
+                __m512i x = _mm512_loadu_si512(a + n - 8);
+                __m512i y = _mm512_loadu_si512(b + n - 8);
+                unsigned ne = _mm512_cmpneq_epu64_mask(x, y);
+                if (ne != 0)
+                {
+                    size_t k = n - 8 + (31 - __builtin_clz(ne));
+                    return a[k] > b[k] ? 1 : -1;
+                }
+                n -= 8;
+            }
+            return cmp_n_avx2(a, b, n);
+        }
+
+        __attribute__((target("avx512f"))) size_t normalized_size_avx512(const limb_t *a, size_t n)
+        {
+            while (n >= 8)
+            {
+                __m512i x = _mm512_loadu_si512(a + n - 8);
+                if (_mm512_test_epi64_mask(x, x) != 0)
+                    break;
+                n -= 8;
+            }
+            return normalized_size_avx2(a, n);
+        }
+
+#endif
+
+        struct simd_kernels {
+            const char *name;
+            limb_t (*add_n)(limb_t *, const limb_t *, const limb_t *, size_t);
+            limb_t (*sub_n)(limb_t *, const limb_t *, const limb_t *, size_t);
+            int (*cmp_n)(const limb_t *, const limb_t *, size_t);
+            size_t (*normalized_size)(const limb_t *, size_t);
+        };
+
+        // Лучший набор, поддерживаемый процессором; переменная окружения LONGNUM_SIMD
+        // (avx512, avx2, sse2, generic) ограничивает выбор сверху
+        simd_kernels select_kernels()
+        {
+            const char *limit = std::getenv("LONGNUM_SIMD");
+            auto allowed = [limit](const char *name)
+            {
+                static const char *const order[] = {"generic", "sse2", "avx2", "avx512"};
+                if (limit == nullptr)
+                    return true;
+                int want = -1, have = -1;
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (std::strcmp(order[i], limit) == 0)
+                        want = i;
+                    if (std::strcmp(order[i], name) == 0)
+                        have = i;
+                }
+                return want < 0 || have <= want;
+            };
+#ifdef LONGNUM_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && allowed("avx512"))
+                return {"avx512", add_n_avx512, sub_n_avx512, cmp_n_avx512, normalized_size_avx512};
+            if (__builtin_cpu_supports("avx2") && allowed("avx2"))
+                return {"avx2", add_n_avx2, sub_n_avx2, cmp_n_avx2, normalized_size_avx2};
+            if (__builtin_cpu_supports("sse2") && allowed("sse2"))
+                return {"sse2", add_n_sse2, sub_n_sse2, cmp_n_sse2, normalized_size_sse2};
+#else
+            (void)allowed;
+#endif
+            return {"generic", add_n_generic, sub_n_generic, cmp_n_generic, normalized_size_generic};
+        }
+
+        const simd_kernels &kernels()
+        {
+            static const simd_kernels k = select_kernels();
+            return k;
+        }
+
+    } // end anonymous namespace
+
+    limb_t simd_add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels().add_n(r, a, b, n);
+    }
+
+    limb_t simd_sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels().sub_n(r, a, b, n);
+    }
+
+    int simd_cmp_n(const limb_t *a, const limb_t *b, size_t n)
+    {
+        return kernels().cmp_n(a, b, n);
+    }
+
+    size_t simd_normalized_size(const limb_t *a, size_t n)
+    {
+        return kernels().normalized_size(a, n);
+    }
+
+    const char *simd_name()
+    {
+        return kernels().name;
+    }
+
+} // namespace limbs
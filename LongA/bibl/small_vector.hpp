@@ -0,0 +1,288 @@
+#ifndef LONGNUM_SMALL_VECTOR_HPP
+#define LONGNUM_SMALL_VECTOR_HPP
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "stats.hpp"
+
+// Число слов, которые хранятся прямо в объекте без обращения к куче
+// (по умолчанию 4 слова = 256 бит). Задаётся переменной CMake LONGNUM_INLINE_LIMBS:
+// значение меняет размещение LongNumber, поэтому библиотека и все её пользователи
+// должны собираться с одним и тем же значением (цель bibl передаёт его как PUBLIC)
+#ifndef LONGNUM_INLINE_LIMBS
+#define LONGNUM_INLINE_LIMBS 4
+#endif
+
+namespace limbs {
+
+    // Владелец внешней памяти, отданной вектору через adopt (например, отображения файла)
+    class external_storage {
+    public:
+        virtual ~external_storage() = default;
+    };
+
+    // Вектор с встроенным буфером на N элементов: пока размер не превышает N,
+    // память в куче не выделяется. Интерфейс — подмножество std::vector;
+    // элементы тривиально копируемые, новые элементы заполняются нулём
+    template <class T, std::size_t N>
+    class small_vector {
+        static_assert(std::is_trivially_copyable<T>::value, "small_vector holds trivially copyable types");
+        static_assert(sizeof(T) * N >= sizeof(external_storage *), "inline buffer must fit an owner pointer");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        small_vector() : data_(inline_), size_(0), capacity_(N), external_(0) {}
+
+        explicit small_vector(size_type n, T value = T()) : small_vector()
+        {
+            resize(n, value);
+        }
+
+        template <class It, class = typename std::enable_if<!std::is_integral<It>::value>::type>
+        small_vector(It first, It last) : small_vector()
+        {
+            assign(first, last);
+        }
+
+        small_vector(std::initializer_list<T> values) : small_vector()
+        {
+            assign(values.begin(), values.end());
+        }
+
+        small_vector(const small_vector &other) : small_vector()
+        {
+            assign(other.begin(), other.end());
+        }
+
+        small_vector(small_vector &&other) noexcept : small_vector()
+        {
+            steal(other);
+        }
+
+        ~small_vector()
+        {
+            release();
+        }
+
+        small_vector &operator=(const small_vector &other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        small_vector &operator=(small_vector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                data_ = inline_;
+                capacity_ = N;
+                size_ = 0;
+                steal(other);
+            }
+            return *this;
+        }
+
+        size_type size() const { return size_; }
+        size_type capacity() const { return capacity_; }
+        bool empty() const { return size_ == 0; }
+        // true, если элементы лежат во встроенном буфере
+        bool is_inline() const { return data_ == inline_; }
+        // true, если элементы лежат во внешней памяти, переданной через adopt
+        bool is_external() const { return external_ != 0; }
+
+        T *data() { return data_; }
+        const T *data() const { return data_; }
+        T &operator[](size_type i) { return data_[i]; }
+        const T &operator[](size_type i) const { return data_[i]; }
+        T &front() { return data_[0]; }
+        const T &front() const { return data_[0]; }
+        T &back() { return data_[size_ - 1]; }
+        const T &back() const { return data_[size_ - 1]; }
+
+        iterator begin() { return data_; }
+        iterator end() { return data_ + size_; }
+        const_iterator begin() const { return data_; }
+        const_iterator end() const { return data_ + size_; }
+
+        void reserve(size_type n)
+        {
+            if (n > capacity_)
+                reallocate(n);
+        }
+
+        void resize(size_type n, T value = T())
+        {
+            if (n > capacity_)
+                reallocate(std::max(n, 2 * capacity_));
+            if (n > size_)
+                std::fill(data_ + size_, data_ + n, value);
+            size_ = n;
+        }
+
+        void clear() { size_ = 0; }
+
+        void push_back(const T &value)
+        {
+            if (size_ == capacity_)
+            {
+                T copy = value;
+                reallocate(2 * capacity_);
+                data_[size_++] = copy;
+                return;
+            }
+            data_[size_++] = value;
+        }
+
+        void pop_back() { --size_; }
+
+        template <class It>
+        void assign(It first, It last)
+        {
+            size_type n = static_cast<size_type>(std::distance(first, last));
+            if (n > capacity_)
+            {
+                release();
+                data_ = allocate(n);
+                capacity_ = n;
+            }
+            std::copy(first, last, data_);
+            size_ = n;
+        }
+
+        void assign(size_type n, const T &value)
+        {
+            clear();
+            resize(n, value);
+        }
+
+        // Вставка [first, last) перед pos (диапазон не должен принадлежать самому вектору)
+        template <class It>
+        iterator insert(const_iterator pos, It first, It last)
+        {
+            size_type offset = static_cast<size_type>(pos - data_);
+            size_type n = static_cast<size_type>(std::distance(first, last));
+            if (size_ + n > capacity_)
+                reallocate(std::max(size_ + n, 2 * capacity_));
+            std::copy_backward(data_ + offset, data_ + size_, data_ + size_ + n);
+            std::copy(first, last, data_ + offset);
+            size_ += n;
+            return data_ + offset;
+        }
+
+        // Переход на внешние элементы data[0..n) без копирования; ёмкость равна n.
+        // Операции на месте пишут прямо в эту память, поэтому она должна быть доступна
+        // на запись. Рост сверх n элементов переносит элементы в кучу, как обычное
+        // перераспределение, и удаляет owner; он удаляется и при уничтожении вектора
+        // или перемещающем присваивании
+        void adopt(T *data, size_type n, external_storage *owner)
+        {
+            release();
+            data_ = data;
+            size_ = n;
+            capacity_ = n;
+            external_ = 1;
+            std::memcpy(inline_, &owner, sizeof owner);
+        }
+
+        void swap(small_vector &other) noexcept
+        {
+            small_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        friend bool operator==(const small_vector &a, const small_vector &b)
+        {
+            return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+        }
+
+        friend bool operator!=(const small_vector &a, const small_vector &b)
+        {
+            return !(a == b);
+        }
+
+    private:
+        static T *allocate(size_type n)
+        {
+            LONGNUM_STATS_ALLOC(n * sizeof(T));
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        // Владелец внешней памяти хранится в неиспользуемом встроенном буфере
+        external_storage *owner() const
+        {
+            external_storage *p;
+            std::memcpy(&p, inline_, sizeof p);
+            return p;
+        }
+
+        void release()
+        {
+            if (external_)
+            {
+                delete owner();
+                external_ = 0;
+            }
+            else if (data_ != inline_)
+                ::operator delete(data_);
+        }
+
+        void reallocate(size_type n)
+        {
+            T *fresh = allocate(n);
+            if (size_ > 0)
+                std::memcpy(fresh, data_, size_ * sizeof(T));
+            release();
+            data_ = fresh;
+            capacity_ = n;
+        }
+
+        // Перенос содержимого other в пустой вектор со встроенным буфером
+        void steal(small_vector &other)
+        {
+            if (other.data_ == other.inline_)
+            {
+                std::copy(other.begin(), other.end(), inline_);
+            }
+            else
+            {
+                data_ = other.data_;
+                capacity_ = other.capacity_;
+                external_ = other.external_;
+                if (external_)
+                    std::memcpy(inline_, other.inline_, sizeof(external_storage *));
+                other.data_ = other.inline_;
+                other.capacity_ = N;
+                other.external_ = 0;
+            }
+            size_ = other.size_;
+            other.size_ = 0;
+        }
+
+        T *data_;
+        size_type size_;
+        size_type capacity_ : 63;
+        size_type external_ : 1;        // data_ принадлежит owner(), а не куче
+        T inline_[N];
+    };
+
+    using limb_vector = small_vector<std::uint64_t, LONGNUM_INLINE_LIMBS>;
+
+} // namespace limbs
+
+#endif
@@ -0,0 +1,157 @@
+#include "stats.hpp"
+#include "limbs.hpp"
+#include "scratch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <ostream>
+
+namespace stats {
+
+    namespace {
+
+        constexpr std::size_t OPS = static_cast<std::size_t>(op::count);
+        constexpr std::size_t TIERS = static_cast<std::size_t>(tier::count);
+
+        // Счётчики общие для всех потоков; порядок между ними не важен
+        struct counters {
+            std::atomic<std::uint64_t> calls[OPS];
+            std::atomic<std::uint64_t> nanoseconds[OPS];
+            std::atomic<std::uint64_t> sizes[OPS][SIZE_BUCKETS];
+            std::atomic<std::uint64_t> tiers[TIERS];
+            std::atomic<std::uint64_t> allocations;
+            std::atomic<std::uint64_t> bytes_allocated;
+        };
+
+        counters global;
+
+        std::size_t bucket(std::size_t words)
+        {
+            std::size_t k = words == 0 ? 0 : 64 - __builtin_clzll(words);
+            return std::min(k, SIZE_BUCKETS - 1);
+        }
+
+        void add(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+        {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        std::uint64_t load(const std::atomic<std::uint64_t> &counter)
+        {
+            return counter.load(std::memory_order_relaxed);
+        }
+
+    } // end anonymous namespace
+
+    const char *name(op o)
+    {
+        static const char *const names[OPS] = {"add", "mul", "sqr", "div", "mul_word", "div_word",
+                                                "expr", "shift", "compare", "sqrt", "from_string", "to_string"};
+        return names[static_cast<std::size_t>(o)];
+    }
+
+    const char *name(tier t)
+    {
+        static const char *const names[TIERS] = {"mul_basecase", "mul_karatsuba", "mul_toom3", "mul_ntt",
+                                                  "sqr_basecase", "sqr_karatsuba", "sqr_toom3", "sqr_ntt",
+                                                  "mul_short", "div_schoolbook", "div_newton"};
+        return names[static_cast<std::size_t>(t)];
+    }
+
+    void record_op(op o, std::size_t words, std::uint64_t nanoseconds)
+    {
+        std::size_t i = static_cast<std::size_t>(o);
+        add(global.calls[i], 1);
+        add(global.nanoseconds[i], nanoseconds);
+        add(global.sizes[i][bucket(words)], 1);
+    }
+
+    void record_tier(tier t)
+    {
+        add(global.tiers[static_cast<std::size_t>(t)], 1);
+    }
+
+    void record_allocation(std::size_t bytes)
+    {
+        add(global.allocations, 1);
+        add(global.bytes_allocated, bytes);
+    }
+
+    snapshot take()
+    {
+        snapshot s{};
+        for (std::size_t i = 0; i < OPS; ++i)
+        {
+            s.ops[i].calls = load(global.calls[i]);
+            s.ops[i].nanoseconds = load(global.nanoseconds[i]);
+            for (std::size_t k = 0; k < SIZE_BUCKETS; ++k)
+                s.ops[i].sizes[k] = load(global.sizes[i][k]);
+        }
+        for (std::size_t i = 0; i < TIERS; ++i)
+            s.tiers[i] = load(global.tiers[i]);
+        s.allocations = load(global.allocations);
+        s.bytes_allocated = load(global.bytes_allocated);
+        s.scratch_peak_bytes = limbs::scratch_peak_bytes();
+        return s;
+    }
+
+    void reset()
+    {
+        for (std::size_t i = 0; i < OPS; ++i)
+        {
+            global.calls[i].store(0, std::memory_order_relaxed);
+            global.nanoseconds[i].store(0, std::memory_order_relaxed);
+            for (auto &counter : global.sizes[i])
+                counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto &counter : global.tiers)
+            counter.store(0, std::memory_order_relaxed);
+        global.allocations.store(0, std::memory_order_relaxed);
+        global.bytes_allocated.store(0, std::memory_order_relaxed);
+        limbs::scratch_reset_peak();
+    }
+
+    void print(std::ostream &os, const snapshot &s)
+    {
+        os << "kernels: simd " << limbs::simd_name() << ", mul_basecase " << limbs::mul_basecase_name() << "\n";
+        if (!enabled)
+        {
+            os << "operation counters are disabled (configure with -DLONGNUM_STATS=ON)\n";
+            os << "scratch peak: " << s.scratch_peak_bytes << " bytes\n";
+            return;
+        }
+
+        os << std::left << std::setw(13) << "operation" << std::right << std::setw(12) << "calls"
+           << std::setw(14) << "total ms" << std::setw(12) << "mean us" << "   operand words: calls\n";
+        for (std::size_t i = 0; i < OPS; ++i)
+        {
+            const op_counters &c = s.ops[i];
+            if (c.calls == 0)
+                continue;
+            os << std::left << std::setw(13) << name(static_cast<op>(i)) << std::right << std::setw(12) << c.calls
+               << std::fixed << std::setprecision(3) << std::setw(14) << c.nanoseconds / 1e6
+               << std::setw(12) << c.nanoseconds / 1e3 / c.calls << "  ";
+            for (std::size_t k = 0; k < SIZE_BUCKETS; ++k)
+            {
+                if (c.sizes[k] == 0)
+                    continue;
+                if (k <= 1)
+                    os << ' ' << k;
+                else
+                    os << ' ' << (std::uint64_t(1) << (k - 1)) << '-' << (std::uint64_t(1) << k) - 1;
+                os << ": " << c.sizes[k];
+            }
+            os << "\n";
+        }
+
+        os << "algorithms:";
+        for (std::size_t i = 0; i < TIERS; ++i)
+        {
+            if (s.tiers[i] != 0)
+                os << ' ' << name(static_cast<tier>(i)) << ' ' << s.tiers[i];
+        }
+        os << "\nlimb allocations: " << s.allocations << " (" << s.bytes_allocated << " bytes), scratch peak: "
+           << s.scratch_peak_bytes << " bytes\n";
+    }
+
+} // namespace stats
@@ -0,0 +1,121 @@
+#ifndef LONGNUM_STATS_HPP
+#define LONGNUM_STATS_HPP
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Счётчики горячих путей: вызовы и время операций LongNumber, гистограммы размеров
+// операндов, выбор алгоритмов умножения и деления, выделения памяти.
+// Включаются опцией CMake LONGNUM_STATS (по умолчанию выключена): без неё макросы
+// LONGNUM_STATS_* пусты и код счётчиков в горячих путях не компилируется.
+#ifndef LONGNUM_STATS
+#define LONGNUM_STATS 0
+#endif
+
+namespace stats {
+
+    constexpr bool enabled = LONGNUM_STATS != 0;
+
+    // Операции LongNumber (время включает вложенные операции)
+    enum class op {
+        add,            // +, -, +=, -= (в том числе с машинным словом)
+        mul,
+        sqr,
+        div,
+        mul_word,       // умножение на машинное слово
+        div_word,       // деление на машинное слово
+        expr,           // вычисление ленивой суммы ±x / d
+        shift,
+        compare,
+        sqrt,
+        from_string,
+        to_string,      // to_string, write_decimal, operator<<
+        count
+    };
+
+    // Алгоритмы на верхнем уровне limbs::mul, limbs::sqr, limbs::mul_shr и limbs::divrem
+    enum class tier {
+        mul_basecase,
+        mul_karatsuba,
+        mul_toom3,
+        mul_ntt,
+        sqr_basecase,
+        sqr_karatsuba,
+        sqr_toom3,
+        sqr_ntt,
+        mul_short,      // короткое произведение в mul_shr
+        div_schoolbook,
+        div_newton,
+        count
+    };
+
+    // Корзина k гистограммы — операнды из [2^(k-1), 2^k) слов, корзина 0 — пустые
+    constexpr std::size_t SIZE_BUCKETS = 32;
+
+    struct op_counters {
+        std::uint64_t calls;
+        std::uint64_t nanoseconds;
+        std::uint64_t sizes[SIZE_BUCKETS];
+    };
+
+    struct snapshot {
+        op_counters ops[static_cast<std::size_t>(op::count)];
+        std::uint64_t tiers[static_cast<std::size_t>(tier::count)];
+        // Выделения буферов слов: куча limb_vector (small_vector::allocate) и новые блоки
+        // арены scratch. Таблицы корней NTT (std::vector в ntt.cpp) и буферы std::string /
+        // std::vector десятичного перевода (radix.cpp, to_string) не учитываются
+        std::uint64_t allocations;
+        std::uint64_t bytes_allocated;
+        std::size_t scratch_peak_bytes;
+    };
+
+    const char *name(op o);
+    const char *name(tier t);
+
+    // Текущие значения счётчиков всех потоков и их сброс
+    snapshot take();
+    void reset();
+    // Таблица ненулевых счётчиков
+    void print(std::ostream &os, const snapshot &s);
+
+    void record_op(op o, std::size_t words, std::uint64_t nanoseconds);
+    void record_tier(tier t);
+    void record_allocation(std::size_t bytes);
+
+    // Замер операции от создания до конца области видимости
+    class scoped_timer {
+    public:
+        scoped_timer(op o, std::size_t words)
+            : op_(o), words_(words), start_(std::chrono::steady_clock::now()) {}
+
+        ~scoped_timer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            record_op(op_, words_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+        scoped_timer(const scoped_timer &) = delete;
+        scoped_timer &operator=(const scoped_timer &) = delete;
+
+    private:
+        op op_;
+        std::size_t words_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace stats
+
+#if LONGNUM_STATS
+#define LONGNUM_STATS_OP(o, words) ::stats::scoped_timer longnum_stats_timer_(::stats::op::o, (words))
+#define LONGNUM_STATS_TIER(t) ::stats::record_tier(::stats::tier::t)
+#define LONGNUM_STATS_ALLOC(bytes) ::stats::record_allocation(bytes)
+#else
+#define LONGNUM_STATS_OP(o, words) ((void)0)
+#define LONGNUM_STATS_TIER(t) ((void)0)
+#define LONGNUM_STATS_ALLOC(bytes) ((void)0)
+#endif
+
+#endif
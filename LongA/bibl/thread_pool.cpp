@@ -0,0 +1,107 @@
+#include "thread_pool.hpp"
+
+namespace {
+
+    // Пул и номер очереди рабочего потока, в котором выполняется код
+    thread_local const ThreadPool *current_pool = nullptr;
+    thread_local unsigned current_index = 0;
+
+} // end anonymous namespace
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    unsigned workers = threads > 1 ? threads - 1 : 0;
+    for (unsigned i = 0; i <= workers; ++i)
+    {
+        queues_.push_back(std::make_unique<task_queue>());
+    }
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::queue_index() const
+{
+    if (current_pool == this)
+        return current_index;
+    return static_cast<unsigned>(workers_.size());
+}
+
+void ThreadPool::push(std::function<void()> task)
+{
+    task_queue &queue = *queues_[queue_index()];
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        pending_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::pop(std::function<void()> &task)
+{
+    unsigned own = queue_index();
+    unsigned n = static_cast<unsigned>(queues_.size());
+    for (unsigned i = 0; i < n; ++i)
+    {
+        task_queue &queue = *queues_[(own + i) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        // Свою очередь разбираем с конца (LIFO), чужие — с начала
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        pending_--;
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::run_one()
+{
+    std::function<void()> task;
+    if (!pop(task))
+        return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(unsigned index)
+{
+    current_pool = this;
+    current_index = index;
+    while (true)
+    {
+        if (run_one())
+            continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stop_ || pending_ > 0; });
+        if (stop_ && pending_ == 0)
+            return;
+    }
+}
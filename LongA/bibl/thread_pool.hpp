@@ -0,0 +1,73 @@
+#ifndef LONGNUM_THREAD_POOL_HPP
+#define LONGNUM_THREAD_POOL_HPP
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом задач (work stealing): у каждого потока своя очередь,
+// свободный поток забирает задачи из начала чужих очередей
+class ThreadPool {
+public:
+    // threads — общее число потоков, включая вызывающий (он выполняет задачи в wait)
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Постановка задачи в очередь текущего потока
+    template <class F>
+    auto submit(F f) -> std::future<decltype(f())>
+    {
+        using result_type = decltype(f());
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(f));
+        std::future<result_type> result = task->get_future();
+        push([task]() { (*task)(); });
+        return result;
+    }
+
+    // Ожидание результата; пока его нет, поток выполняет другие задачи пула
+    template <class T>
+    T wait(std::future<T> &future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if (!run_one())
+                std::this_thread::yield();
+        }
+        return future.get();
+    }
+
+private:
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task);
+    bool pop(std::function<void()> &task);
+    bool run_one();
+    void worker_loop(unsigned index);
+    unsigned queue_index() const;
+
+    // Последняя очередь принадлежит внешним (не рабочим) потокам
+    std::vector<std::unique_ptr<task_queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> stop_{false};
+};
+
+#endif
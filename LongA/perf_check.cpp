@@ -0,0 +1,220 @@
+#include "head.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Проверка производительности на фиксированном наборе задач (ctest -L perf при сборке
+// с -DLONGNUM_PERF_GATE=ON).
+//
+//   perf_check <baseline> [--tolerance T] [--runs N] [--update]
+//
+// Время задачи — лучшее из запусков (не меньше N и не меньше 0.5 с в сумме), делённое
+// на время калибровочного цикла (цепочка умножений машинных слов), чтобы базовые значения
+// меньше зависели от частоты машины. Задача считается замедлившейся, если отношение
+// превышает базовое больше чем в (1 + допуск) раз. Допуск задаётся --tolerance для всех
+// задач сразу, иначе берётся из строки файла (по умолчанию 0.3).
+// --update перезаписывает файл текущими значениями, сохраняя допуски.
+//
+// Формат файла: строки "имя отношение [допуск]", '#' — комментарий
+
+namespace {
+
+    using perf_clock = std::chrono::steady_clock;
+
+    volatile std::uint64_t sink = 0;
+
+    struct workload {
+        std::string name;
+        std::function<void()> run;
+    };
+
+    struct baseline_entry {
+        double ratio;
+        double tolerance;   // < 0 — не задан
+    };
+
+    double seconds_since(perf_clock::time_point start)
+    {
+        return std::chrono::duration<double>(perf_clock::now() - start).count();
+    }
+
+    // Лучшее время запуска, в секундах: не меньше runs запусков и не меньше 0.5 с в сумме,
+    // чтобы у коротких задач минимум не зависел от случайных помех
+    double best_time(const std::function<void()> &f, int runs)
+    {
+        double best = 1e300;
+        auto total_start = perf_clock::now();
+        for (int i = 0; i < runs || (seconds_since(total_start) < 0.5 && i < 1000); ++i)
+        {
+            auto start = perf_clock::now();
+            f();
+            best = std::min(best, seconds_since(start));
+        }
+        return best;
+    }
+
+    void calibration()
+    {
+        std::uint64_t x = sink + 1;
+        for (int i = 0; i < 20000000; ++i)
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        sink = x;
+    }
+
+    LongNumber random_number(std::mt19937_64 &gen, std::size_t bits)
+    {
+        std::size_t digits = bits * 30103 / 100000 / 2 + 1;
+        std::string text(2 * digits + 1, '0');
+        for (auto &c : text)
+            c = static_cast<char>('0' + gen() % 10);
+        text[0] = '7';
+        text[digits] = '.';
+        return LongNumber(text, static_cast<int>(bits / 2));
+    }
+
+    std::vector<workload> make_workloads()
+    {
+        std::mt19937_64 gen(1);
+        auto a = std::make_shared<LongNumber>(random_number(gen, 100000));
+        auto b = std::make_shared<LongNumber>(random_number(gen, 100000));
+        auto big = std::make_shared<LongNumber>(random_number(gen, 1000000));
+        return {
+            // Точность pi — 4 бита на цифру, как в pi.cpp
+            {"pi_1k_digits", [] { sink = sink + LongNumber::calculate_pi(4 * 1000).to_string().size(); }},
+            {"pi_10k_digits", [] { sink = sink + LongNumber::calculate_pi(4 * 10000).to_string().size(); }},
+            {"mul_100k_bits", [a, b] { sink = sink + (*a * *b).get_limbs().size(); }},
+            {"div_100k_bits", [a, b] { sink = sink + (*a / *b).get_limbs().size(); }},
+            {"to_string_1m_bits", [big] { sink = sink + big->to_string().size(); }},
+        };
+    }
+
+    std::map<std::string, baseline_entry> read_baseline(const std::string &path)
+    {
+        std::map<std::string, baseline_entry> result;
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("cannot open baseline file " + path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line.substr(0, line.find('#')));
+            std::string name;
+            baseline_entry entry{0, -1};
+            if (!(fields >> name))
+                continue;
+            if (!(fields >> entry.ratio))
+                throw std::runtime_error("bad baseline line: " + line);
+            fields >> entry.tolerance;
+            result[name] = entry;
+        }
+        return result;
+    }
+
+    void write_baseline(const std::string &path, const std::vector<std::pair<std::string, double>> &measured,
+                        const std::map<std::string, baseline_entry> &old)
+    {
+        std::ofstream out(path);
+        if (!out)
+            throw std::runtime_error("cannot write baseline file " + path);
+        out << "# Базовые значения perf_check: имя, время / время калибровки, допуск (доля замедления)\n";
+        out << std::fixed << std::setprecision(4);
+        for (const auto &[name, ratio] : measured)
+        {
+            auto it = old.find(name);
+            double tolerance = it != old.end() && it->second.tolerance >= 0 ? it->second.tolerance : 0.3;
+            out << name << ' ' << ratio << ' ' << std::setprecision(2) << tolerance << std::setprecision(4) << '\n';
+        }
+    }
+
+} // end anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: perf_check <baseline> [--tolerance T] [--runs N] [--update]\n";
+        return 2;
+    }
+    std::string path = argv[1];
+    double tolerance = -1;
+    int runs = 5;
+    bool update = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = std::stod(argv[++i]);
+        else if (arg == "--runs" && i + 1 < argc)
+            runs = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--update")
+            update = true;
+        else
+        {
+            std::cerr << "unknown option: " << arg << "\n";
+            return 2;
+        }
+    }
+
+    try
+    {
+        std::map<std::string, baseline_entry> baseline;
+        if (!update)
+            baseline = read_baseline(path);
+        else if (std::ifstream(path))
+            baseline = read_baseline(path);
+
+        double unit = best_time(calibration, runs);
+        std::vector<std::pair<std::string, double>> measured;
+        for (const workload &w : make_workloads())
+        {
+            w.run();
+            measured.emplace_back(w.name, best_time(w.run, runs) / unit);
+        }
+
+        if (update)
+        {
+            write_baseline(path, measured, baseline);
+            std::cout << "baseline written to " << path << "\n";
+            return 0;
+        }
+
+        bool failed = false;
+        std::cout << "calibration: " << std::fixed << std::setprecision(1) << unit * 1e3 << " ms\n"
+                  << std::left << std::setw(20) << "workload" << std::right << std::setw(12) << "baseline"
+                  << std::setw(12) << "measured" << std::setw(10) << "change" << std::setw(10) << "limit" << "  status\n";
+        for (const auto &[name, ratio] : measured)
+        {
+            auto it = baseline.find(name);
+            std::cout << std::left << std::setw(20) << name << std::right << std::setprecision(4);
+            if (it == baseline.end())
+            {
+                std::cout << std::setw(12) << "-" << std::setw(12) << ratio << "  no baseline\n";
+                continue;
+            }
+            double limit = tolerance >= 0 ? tolerance : it->second.tolerance >= 0 ? it->second.tolerance : 0.3;
+            double change = ratio / it->second.ratio - 1;
+            bool slow = change > limit;
+            failed = failed || slow;
+            std::cout << std::setw(12) << it->second.ratio << std::setw(12) << ratio << std::setprecision(1)
+                      << std::setw(9) << change * 100 << '%' << std::setw(9) << limit * 100 << '%'
+                      << (slow ? "  REGRESSION" : "  ok") << "\n";
+        }
+        return failed ? 1 : 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+}
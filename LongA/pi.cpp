@@ -1,53 +1,209 @@
 #include "head.hpp"
+#include "thread_pool.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <string>
 #include <iomanip>
 #include <cmath>
 #include <chrono>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
 
-LongNumber calculate_pi(int precision) {
-    LongNumber pi(0.0, precision, false);
-    LongNumber n0(1.0, precision, false);
-    LongNumber n(16.0, precision, false);
+// Сумма членов ряда BBP с номерами [from, to); половины диапазона
+// считаются параллельно и складываются деревом
+LongNumber sum_terms(int from, int to, int precision, ThreadPool *pool) {
+    const int grain = 64;
+    if (pool != nullptr && to - from > grain) {
+        int mid = from + (to - from) / 2;
+        auto left = pool->submit([=] { return sum_terms(from, mid, precision, pool); });
+        LongNumber right = sum_terms(mid, to, precision, pool);
+        return pool->wait(left) + right;
+    }
+
+    LongNumber sum(0.0, precision, false);
 
     LongNumber a0(4.0, precision, false);
     LongNumber b0(2.0, precision, false);
     LongNumber c0(1.0, precision, false);
     LongNumber d0(1.0, precision, false);
 
-    LongNumber a(1.0, precision, false);
-    LongNumber b(4.0, precision, false);
-    LongNumber c(5.0, precision, false);
-    LongNumber d(6.0, precision, false);
+    // Член ряда вычисляется одним проходом и сразу прибавляется к сумме; сдвиг на 4k бит
+    // ленивый: слова частных, уходящие за точность, не считаются
+    for (int k = from; k < to; ++k) {
+        std::int64_t m = 8LL * k;
+        sum += (a0 / (m + 1) - b0 / (m + 4) - c0 / (m + 5) - d0 / (m + 6)) >> (4 * k);
+    }
 
-    LongNumber eight(8.0, precision, false);
+    return sum;
+}
 
-    if (precision == 0) {
-        pi = pi + LongNumber(3.0, precision, false);
+// Запись цифр в файловый дескриптор блоками фиксированного размера: цифры приходят
+// от LongNumber::write_decimal по мере перевода, и память вывода не растёт с длиной числа.
+// При group цифры после точки разбиваются на группы по 10 через пробел, по 100 в строке
+class digit_writer {
+public:
+    digit_writer(int fd, bool group) : fd_(fd), group_(group) {}
+
+    void write(const char *digits, size_t n) {
+        if (!group_) {
+            while (n > 0) {
+                size_t part = std::min(n, BLOCK - used_);
+                std::memcpy(buffer_ + used_, digits, part);
+                used_ += part;
+                digits += part;
+                n -= part;
+                if (used_ == BLOCK)
+                    flush();
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (fraction_ && written_ > 0 && written_ % 10 == 0)
+                put(written_ % 100 == 0 ? '\n' : ' ');
+            put(digits[i]);
+            if (fraction_)
+                ++written_;
+            else if (digits[i] == '.')
+                fraction_ = true;
+        }
+    }
+
+    // Завершающий перевод строки (вне групп цифр) и сброс буфера
+    void finish() {
+        put('\n');
+        flush();
+    }
+
+    void flush() {
+        size_t done = 0;
+        while (done < used_) {
+            ssize_t w = ::write(fd_, buffer_ + done, used_ - done);
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w < 0)
+                throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+            done += static_cast<size_t>(w);
+        }
+        used_ = 0;
+    }
+
+private:
+    static constexpr size_t BLOCK = 1 << 16;
+
+    void put(char c) {
+        buffer_[used_++] = c;
+        if (used_ == BLOCK)
+            flush();
     }
 
-    for (int k = 0; k < precision/4; ++k) {
-        pi = pi + ((a0 / a - b0 / b - c0 / c - d0 / d) >> (4 * k));
-        a = a + eight;
-        b = b + eight;
-        c = c + eight;
-        d = d + eight;
+    int fd_;
+    bool group_;
+    bool fraction_ = false;
+    size_t written_ = 0;
+    size_t used_ = 0;
+    char buffer_[BLOCK];
+};
+
+LongNumber calculate_pi(int precision, unsigned threads) {
+    LongNumber pi(0.0, precision, false);
+
+    if (precision == 0) {
+        pi += 3;
     }
 
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1)
+        pool = std::make_unique<ThreadPool>(threads);
+
+    pi += sum_terms(0, precision/4, precision, pool.get());
+
     return pi;
 }
 
+// Неотрицательное целое из аргумента командной строки целиком
+int parse_count(const std::string &text) {
+    size_t end = 0;
+    int value = std::stoi(text, &end);
+    if (end != text.size() || value < 0)
+        throw std::invalid_argument(text);
+    return value;
+}
+
+int usage(const char *program) {
+    std::cerr << "usage: " << program
+              << " DIGITS [--chudnovsky] [--threads N] [--stats] [--group] [--output FILE]\n";
+    return 2;
+}
+
 int main(int argc, char *argv[])
 {   
     auto start_time = std::chrono::steady_clock::now();
     
-    int precision = std::stoi(argv[1]) * 4;
-    LongNumber pi = calculate_pi(precision);
-    std::cout << pi << std::endl;
+    if (argc < 2)
+        return usage(argv[0]);
+    int precision = 0;
+    bool chudnovsky = false;
+    bool print_stats = false;
+    bool group = false;
+    std::string output;
+    unsigned threads = 1;
+    try {
+        precision = parse_count(argv[1]) * 4;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--chudnovsky")
+                chudnovsky = true;
+            else if (arg == "--threads" && has_value)
+                threads = std::max(1, parse_count(argv[++i]));
+            else if (arg == "--stats")
+                print_stats = true;
+            else if (arg == "--group")
+                group = true;
+            else if (arg == "--output" && has_value)
+                output = argv[++i];
+            else {
+                std::cerr << (arg == "--threads" || arg == "--output" ? "missing value for " : "unknown option ")
+                          << arg << "\n";
+                return usage(argv[0]);
+            }
+        }
+    } catch (const std::logic_error &) {
+        // std::stoi: не число или переполнение
+        std::cerr << "invalid number in arguments\n";
+        return usage(argv[0]);
+    }
+
+    // Цифры пишутся прямо в stdout или в файл --output
+    int fd = STDOUT_FILENO;
+    if (!output.empty()) {
+        fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "cannot open " << output << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+    stats::reset();
+    LongNumber pi = chudnovsky ? LongNumber::calculate_pi_chudnovsky(precision, threads)
+                               : calculate_pi(precision, threads);
+    auto writer = std::make_unique<digit_writer>(fd, group);
+    pi.write_decimal([&writer](const char *digits, size_t n) { writer->write(digits, n); });
+    writer->finish();
+    if (fd != STDOUT_FILENO)
+        ::close(fd);
 
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Pi calculate in " << duration.count() << " ms\n";
 
+    // Счётчики операций (полные — при сборке с -DLONGNUM_STATS=ON) идут в stderr,
+    // чтобы не смешиваться с цифрами
+    if (print_stats)
+        stats::print(std::cerr, stats::take());
+
     return 0;
 }
\ No newline at end of file
@@ -1,9 +1,49 @@
 #include "head.hpp"
+#include "fixed.hpp"
+#include "limbs.hpp"
+#include <cstdio>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <unistd.h>
+
+// Операции FixedLong с FracBits битами после запятой против тех же операций LongNumber
+// (оба отбрасывают лишние биты модуля); отрицательные операнды идут в дополнительном коде
+template <int FracBits>
+bool fixed_matches_long(const LongNumber &x, const LongNumber &y)
+{
+    using fixed = FixedLong<8, FracBits>;
+    fixed fa(x), fb(y);
+    // Те же операнды, приведённые к точности FracBits
+    LongNumber a = fa.to_long_number(), b = fb.to_long_number();
+    return (fa + fb).to_long_number() == a + b && (fa - fb).to_long_number() == a - b
+           && (fa * fb).to_long_number() == a * b && (fa / 7).to_long_number() == LongNumber(a / 7)
+           && (fb / -3).to_long_number() == LongNumber(b / -3) && (fa >> 5).to_long_number() == (a >> 5)
+           && (-fb).to_long_number() == -b && (fa < fb) == (a < b);
+}
 
 int main() {
     std::cout << "=== Тесты арифметических операций с длинными числами ===" << std::endl;
+    std::cout << "ядра: simd " << limbs::simd_name() << ", mul_basecase " << limbs::mul_basecase_name() << std::endl;
+
+    // Проверки с точным ответом: печатают результат, при несовпадении код возврата ненулевой
+    int failures = 0;
+    auto check = [&failures](const std::string &name, bool ok) {
+        std::cout << name << ": " << (ok ? "совпадает" : "НЕ СОВПАДАЕТ") << std::endl;
+        if (!ok)
+            ++failures;
+    };
+    // Десятичная строка из n цифр без ведущего нуля (детерминированный генератор)
+    auto random_digits = [](size_t n, std::uint64_t seed) {
+        std::string digits(n, '0');
+        for (auto &c : digits)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            c = static_cast<char>('0' + (seed >> 33) % 10);
+        }
+        digits[0] = '7';
+        return digits;
+    };
     
     // Тест 1: Сложение двух положительных чисел с разной длиной дробной части
     LongNumber t1("123.456", 50);
@@ -88,6 +128,129 @@ int main() {
     LongNumber res12 = t23 - t24;
     std::cout << t23.to_string() << " - " << t24.to_string() << " = "
               << res12.to_string() << " (ожидается примерно: 1000000000.000000000)" << std::endl;
-    
-    return 0;
+
+    // Тест 13: Pi с фиксированной точкой, вычисленное при компиляции (256 бит и наибольшая
+    // точность PI_CONSTEXPR_FRAC_BITS), и операции FixedLong против LongNumber
+    constexpr FixedLong<2, 256> fixed_pi = FixedLong<2, 256>::pi();
+    std::cout << "FixedLong<2, 256>::pi() = " << fixed_pi.to_string() << std::endl;
+    check("FixedLong<2, 256>::pi() == calculate_pi(256)", fixed_pi.to_long_number() == LongNumber::calculate_pi(256));
+    constexpr int wide = FixedLong<2, 3072>::PI_CONSTEXPR_FRAC_BITS;
+    constexpr FixedLong<2, wide> wide_pi = FixedLong<2, wide>::pi();
+    check("FixedLong<2, 3072>::pi() при компиляции == calculate_pi(3072)",
+          wide_pi.to_long_number() == LongNumber::calculate_pi(wide));
+    {
+        LongNumber a("-5." + random_digits(1000, 7), 3072), b("3." + random_digits(1000, 8), 3072);
+        LongNumber c("2." + random_digits(1000, 9), 3072), d("-9." + random_digits(1000, 10), 3072);
+        bool ok = true;
+        for (const auto &[x, y] : {std::pair{a, b}, std::pair{b, a}, std::pair{c, d}, std::pair{d, a}})
+        {
+            ok = ok && fixed_matches_long<64>(x, y) && fixed_matches_long<128>(x, y)
+                 && fixed_matches_long<1024>(x, y) && fixed_matches_long<3072>(x, y);
+        }
+        check("FixedLong + - * / >> < против LongNumber, 64..3072 бит", ok);
+    }
+
+    // Тест 14: Сохранение в двоичный файл и загрузка (чтением и отображением в память)
+    auto same_bits = [](const LongNumber &a, const LongNumber &b) {
+        return a.get_limbs() == b.get_limbs() && a.get_precision() == b.get_precision()
+               && a.get_is_negative() == b.get_is_negative();
+    };
+    // Имя с номером процесса: ctest запускает тест параллельно с разными ядрами
+    const std::string bin = "longnum_test." + std::to_string(::getpid()) + ".bin";
+    LongNumber t25 = -LongNumber::calculate_pi(1024);
+    t25.save(bin);
+    check("save/load(-pi)", same_bits(LongNumber::load(bin), t25));
+    LongNumber mapped = LongNumber::load_mapped(bin);
+    check("load_mapped(-pi), слова на месте", same_bits(mapped, t25) && mapped.get_limbs().is_external());
+    // Операции на месте над отображённым числом не меняют файл (MAP_PRIVATE)
+    mapped += LongNumber("1.5", 1024);
+    mapped >>= 3;
+    check("load_mapped: += и >>= на месте", mapped.get_limbs().is_external()
+          && same_bits(mapped, (t25 + LongNumber("1.5", 1024)) >> 3));
+    check("файл после изменения отображённого числа", same_bits(LongNumber::load(bin), t25));
+    // Рост сверх отображённых слов переносит число в кучу
+    LongNumber grown = LongNumber::load_mapped(bin);
+    LongNumber big("123456789012345678901234567890123456789012345678901234567890", 1024);
+    grown += big;
+    check("load_mapped: рост сверх файла", !grown.get_limbs().is_external() && same_bits(grown, t25 + big));
+    // Сохранение отображённого числа в его же файл
+    LongNumber::load_mapped(bin).save(bin);
+    check("load_mapped(path).save(path)", same_bits(LongNumber::load(bin), t25));
+    std::remove(bin.c_str());
+
+    // Тест 15: Умножение через NTT (операнды от MUL_NTT_THRESHOLD = 6144 слов):
+    // (10^n - 1)(10^n + 1) = 10^2n - 1, (10^n - 1)^2 = 9..98 0..01, (x * y) / y = x
+    {
+        const size_t n = 130000;    // 10^n — около 6750 слов
+        LongNumber nines(std::string(n, '9'), 0);
+        LongNumber ten_plus_one("1" + std::string(n - 1, '0') + "1", 0);
+        check("(10^n - 1)(10^n + 1), NTT", (nines * ten_plus_one).to_string() == std::string(2 * n, '9') + ".0");
+        check("(10^n - 1)^2, NTT", nines.sqr().to_string()
+              == std::string(n - 1, '9') + "8" + std::string(n - 1, '0') + "1.0");
+        LongNumber x(random_digits(n, 1), 0);
+        LongNumber y(random_digits(n + 5000, 2), 0);
+        check("(x * y) / y == x, NTT", (x * y) / y == x);
+    }
+
+    // Тест 16: Деление через обратную величину (делитель от DIV_NEWTON_THRESHOLD = 1024 слов):
+    // (10^2n - 1) / (10^n - 1) = 10^n + 1, 10^2n / (10^n - 1) = 10^n + 1 (остаток 1),
+    // (x * y + y - 1) / y = x (остаток на границе)
+    {
+        const size_t n = 30000;     // 10^n — около 1560 слов
+        LongNumber nines(std::string(n, '9'), 0);
+        std::string expected = "1" + std::string(n - 1, '0') + "1.0";
+        check("(10^2n - 1) / (10^n - 1), Newton",
+              (LongNumber(std::string(2 * n, '9'), 0) / nines).to_string() == expected);
+        check("10^2n / (10^n - 1), Newton",
+              (LongNumber("1" + std::string(2 * n, '0'), 0) / nines).to_string() == expected);
+        LongNumber x(random_digits(n, 3), 0);
+        LongNumber y(random_digits(n + 700, 4), 0);
+        LongNumber edge = x * y + y;
+        edge -= 1;
+        check("(x * y + y - 1) / y == x, Newton", edge / y == x);
+    }
+
+    // Тест 17: Разбор длинной десятичной строки "разделяй и властвуй" и обратный перевод:
+    // 100000 цифр с дробью, точно представимой в двоичном виде, и 10^n = (10^n - 1) + 1
+    {
+        std::string digits = "-" + random_digits(100000, 5) + ".125";
+        check("LongNumber(s).to_string() == s, 100000 цифр", LongNumber(digits, 3).to_string() == digits);
+        LongNumber nines(std::string(100000, '9'), 0);
+        nines += 1;
+        check("10^n == (10^n - 1) + 1, 100000 цифр", LongNumber("1" + std::string(100000, '0'), 0) == nines);
+    }
+
+    // Тест 18: Короткое произведение limbs::mul_shr против shr(mul): случайные операнды
+    // и граничный случай, где отброшенные слова дают перенос (точный пересчёт)
+    {
+        std::uint64_t seed = 6;
+        auto random_limbs = [&seed](size_t n) {
+            limbs::limb_vector v(n);
+            for (auto &w : v)
+            {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                w = seed ^ (seed >> 29);
+            }
+            v.back() |= 1;
+            return v;
+        };
+        bool ok = true;
+        for (size_t an = 4; an <= 120; an += 7)
+        {
+            for (size_t bn = 1; bn <= an; bn += 5)
+            {
+                limbs::limb_vector a = random_limbs(an), b = random_limbs(bn);
+                for (size_t bits = 64 * 4; bits < 64 * (an + bn); bits += 64 * 3 + 17)
+                    ok = ok && limbs::mul_shr(a, b, bits) == limbs::shr(limbs::mul(a, b), bits);
+            }
+        }
+        check("mul_shr == shr(mul), случайные операнды", ok);
+        // (2^512 - 1)^2 = 2^1024 - 2^513 + 1: слова 9..15 из единиц, окно под отброшенными
+        // словами у переполнения
+        limbs::limb_vector ones(8, ~std::uint64_t(0)), other(ones);
+        check("mul_shr на границе переноса", limbs::mul_shr(ones, other, 64 * 12) == limbs::limb_vector(4, ~std::uint64_t(0))
+              && limbs::mul_shr(ones, other, 64 * 12 + 5) == limbs::shr(limbs::mul(ones, other), 64 * 12 + 5));
+    }
+
+    return failures == 0 ? 0 : 1;
 }